@@ -0,0 +1,13 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Allocation counters for the executables that link src/alloc_count.cpp, which replaces the global operator new to
+// bump them. They stay at zero everywhere else.
+namespace alloc_count {
+
+inline std::atomic<size_t> allocations{0};
+inline std::atomic<size_t> bytes{0};
+
+} // namespace alloc_count
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Asset bundle layout (integers are little-endian):
+//
+//   "ABND" | version u8 | entry count u32 | entries... | data
+//
+// An entry is name length u8 | name | kind u8 | four u32 parameters | data offset u64 | data size u64. Images are
+// R8G8B8A8 pixels with parameters width, height. Sounds are interleaved PCM samples with parameters frame count, sample
+// rate, bits per sample, channels. Data offsets are from the start of the file and 16 byte aligned, so a mapped bundle
+// can be handed to raylib in place. asset_pack writes bundles, render-side loading is in asset_bundle_raylib.hpp.
+namespace assets {
+
+constexpr std::array<uint8_t, 4> bundle_magic = {'A', 'B', 'N', 'D'};
+constexpr uint8_t bundle_version = 1;
+constexpr size_t data_alignment = 16;
+
+enum class AssetKind : uint8_t { Image, Sound };
+
+struct Asset {
+    std::string name;
+    AssetKind kind = AssetKind::Image;
+    std::array<uint32_t, 4> params{};
+    std::span<uint8_t const> data;
+};
+
+// Bytes of pixels or samples the parameters describe
+inline auto dataSize(AssetKind kind, std::array<uint32_t, 4> const& params) -> uint64_t {
+    if (kind == AssetKind::Image) {
+        return uint64_t{params[0]} * params[1] * 4;
+    }
+    return uint64_t{params[0]} * params[3] * (params[2] / 8);
+}
+
+inline void writeInt(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+inline auto readInt(std::span<uint8_t const> in, size_t& pos, size_t bytes) -> std::optional<uint64_t> {
+    if (pos + bytes > in.size()) {
+        return {};
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[pos++]) << (8 * i);
+    }
+    return value;
+}
+
+// Index first, then each asset's data at the next aligned offset. Names longer than 255 bytes are cut.
+inline auto serializeBundle(std::span<Asset const> assets) -> std::vector<uint8_t> {
+    std::vector<uint8_t> out{bundle_magic.begin(), bundle_magic.end()};
+    out.push_back(bundle_version);
+    writeInt(out, assets.size(), 4);
+    size_t index_size = out.size();
+    for (Asset const& asset : assets) {
+        index_size += 1 + std::min<size_t>(asset.name.size(), 255) + 1 + 4 * 4 + 8 + 8;
+    }
+    auto align = [](size_t offset) { return (offset + data_alignment - 1) / data_alignment * data_alignment; };
+    size_t offset = align(index_size);
+    for (Asset const& asset : assets) {
+        std::string_view const name = std::string_view{asset.name}.substr(0, 255);
+        out.push_back(static_cast<uint8_t>(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+        out.push_back(static_cast<uint8_t>(asset.kind));
+        for (uint32_t param : asset.params) {
+            writeInt(out, param, 4);
+        }
+        writeInt(out, offset, 8);
+        writeInt(out, asset.data.size(), 8);
+        offset = align(offset + asset.data.size());
+    }
+    for (Asset const& asset : assets) {
+        out.resize(align(out.size()), 0);
+        out.insert(out.end(), asset.data.begin(), asset.data.end());
+    }
+    return out;
+}
+
+// The assets in `in`, their data pointing into it. Nothing if it is not a bundle of this version, or an entry's data
+// runs past the end or doesn't match its parameters.
+inline auto parseBundle(std::span<uint8_t const> in) -> std::optional<std::vector<Asset>> {
+    if (in.size() < bundle_magic.size() + 1 || !std::equal(bundle_magic.begin(), bundle_magic.end(), in.begin()) ||
+        in[bundle_magic.size()] != bundle_version) {
+        return {};
+    }
+    size_t pos = bundle_magic.size() + 1;
+    std::optional<uint64_t> count = readInt(in, pos, 4);
+    if (!count.has_value()) {
+        return {};
+    }
+    std::vector<Asset> assets;
+    for (uint64_t i = 0; i < count.value(); i++) {
+        std::optional<uint64_t> name_size = readInt(in, pos, 1);
+        if (!name_size.has_value() || pos + name_size.value() > in.size()) {
+            return {};
+        }
+        Asset asset;
+        asset.name.assign(reinterpret_cast<char const*>(in.data() + pos), name_size.value());
+        pos += name_size.value();
+        std::optional<uint64_t> kind = readInt(in, pos, 1);
+        if (!kind.has_value() || kind.value() > static_cast<uint64_t>(AssetKind::Sound)) {
+            return {};
+        }
+        asset.kind = static_cast<AssetKind>(kind.value());
+        for (uint32_t& param : asset.params) {
+            std::optional<uint64_t> value = readInt(in, pos, 4);
+            if (!value.has_value()) {
+                return {};
+            }
+            param = static_cast<uint32_t>(value.value());
+        }
+        std::optional<uint64_t> offset = readInt(in, pos, 8);
+        std::optional<uint64_t> size = readInt(in, pos, 8);
+        if (!offset.has_value() || !size.has_value() || offset.value() > in.size() ||
+            size.value() > in.size() - offset.value()) {
+            return {};
+        }
+        asset.data = in.subspan(offset.value(), size.value());
+        if (asset.data.size() != dataSize(asset.kind, asset.params)) {
+            return {};
+        }
+        assets.push_back(std::move(asset));
+    }
+    return assets;
+}
+
+inline auto writeBundleFile(std::string const& path, std::span<Asset const> assets) -> bool {
+    std::vector<uint8_t> bytes = serializeBundle(assets);
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+// A bundle file mapped read-only for the lifetime of the object, read into memory where there is no mmap. The assets
+// point into the mapping, nothing is copied or decoded.
+struct Bundle {
+    std::vector<Asset> assets;
+    std::span<uint8_t const> bytes;
+#ifdef _WIN32
+    std::vector<uint8_t> storage;
+#endif
+
+    // Empty if `path` can't be read or is not a valid bundle
+    explicit Bundle(std::string const& path) {
+#ifdef _WIN32
+        std::ifstream file{path, std::ios::binary};
+        if (!file) {
+            return;
+        }
+        storage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        bytes = storage;
+#else
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            auto const size = static_cast<size_t>(info.st_size);
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                bytes = {static_cast<uint8_t const*>(mapping), size};
+            }
+        }
+        ::close(fd);
+#endif
+        std::optional<std::vector<Asset>> parsed = parseBundle(bytes);
+        if (parsed.has_value()) {
+            assets = std::move(parsed.value());
+        }
+    }
+
+    ~Bundle() {
+#ifndef _WIN32
+        if (!bytes.empty()) {
+            ::munmap(const_cast<uint8_t*>(bytes.data()), bytes.size());
+        }
+#endif
+    }
+
+    Bundle(Bundle const&) = delete;
+    Bundle(Bundle&&) = delete;
+    auto operator=(Bundle const&) -> Bundle& = delete;
+    auto operator=(Bundle&&) -> Bundle& = delete;
+
+    [[nodiscard]] auto find(std::string_view name, AssetKind kind) const -> Asset const* {
+        auto it = std::find_if(assets.begin(), assets.end(),
+                               [&](Asset const& asset) { return asset.name == name && asset.kind == kind; });
+        return it == assets.end() ? nullptr : &*it;
+    }
+};
+
+} // namespace assets
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "asset_bundle.hpp"
+#include "raylib.h"
+#include <string>
+#include <string_view>
+
+namespace assets {
+
+// raylib views of bundle data. They point into the bundle, so they are uploaded but never unloaded.
+inline auto imageView(Asset const& asset) -> Image {
+    return Image{const_cast<uint8_t*>(asset.data.data()), static_cast<int>(asset.params[0]),
+                 static_cast<int>(asset.params[1]), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+inline auto waveView(Asset const& asset) -> Wave {
+    return Wave{asset.params[0], asset.params[1], asset.params[2], asset.params[3],
+                const_cast<uint8_t*>(asset.data.data())};
+}
+
+// What asset_pack stores for an image file, so loose files and bundles hand raylib the same pixels
+inline auto decodeImage(std::string const& path) -> Image {
+    Image image = LoadImage(path.c_str());
+    if (image.data != nullptr) {
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    return image;
+}
+
+// From the bundle when it has `name`, otherwise decoded from the file `name` in `directory`
+inline auto loadTexture(Bundle const& bundle, std::string const& directory, std::string_view name) -> Texture2D {
+    if (Asset const* asset = bundle.find(name, AssetKind::Image)) {
+        return LoadTextureFromImage(imageView(*asset));
+    }
+    Image image = decodeImage(directory + std::string{name});
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+
+inline auto loadSound(Bundle const& bundle, std::string const& directory, std::string_view name) -> Sound {
+    if (Asset const* asset = bundle.find(name, AssetKind::Sound)) {
+        return LoadSoundFromWave(waveView(*asset));
+    }
+    return LoadSound((directory + std::string{name}).c_str());
+}
+
+} // namespace assets
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "alloc_count.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Micro-benchmark harness: calibrates each case to a minimum repetition time, runs warmup repetitions, then reports
+// per-operation timings over the measured ones as a table, CSV or JSON.
+namespace bench {
+
+enum class Format : uint8_t { Table, Csv, Json };
+
+struct Options {
+    size_t warmup = 3;
+    size_t repetitions = 15;
+    double min_rep_seconds = 0.02;
+    // Only cases whose name contains this run
+    std::string filter;
+    Format format = Format::Table;
+};
+
+// Performs `iterations` operations and returns a value that depends on all of them, so they cannot be elided
+using Run = std::function<uint64_t(size_t iterations)>;
+
+// `setup` builds the case's inputs and returns the operation to time. It is only called for the cases that run, so
+// listing and filtering cost nothing.
+struct Case {
+    std::string name;
+    std::function<Run()> setup;
+};
+
+// Inputs shared by several cases, built the first time one of them is set up
+template <typename T> struct Lazy {
+    std::function<T()> make;
+    std::optional<T> value;
+
+    auto get() -> T& {
+        if (!value.has_value()) {
+            value.emplace(make());
+        }
+        return value.value();
+    }
+};
+
+template <typename Make> auto lazy(Make make) -> std::shared_ptr<Lazy<std::invoke_result_t<Make>>> {
+    return std::make_shared<Lazy<std::invoke_result_t<Make>>>(Lazy<std::invoke_result_t<Make>>{std::move(make), {}});
+}
+
+struct Result {
+    std::string name;
+    size_t iterations = 0;
+    std::vector<double> ns_per_op;
+    double allocs_per_op = 0;
+    double mean = 0;
+    double stddev = 0;
+    double min = 0;
+    double median = 0;
+    double max = 0;
+};
+
+inline volatile uint64_t sink = 0;
+
+inline auto timeRun(Run const& run, size_t iterations) -> double {
+    auto start = std::chrono::steady_clock::now();
+    sink = sink + run(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline auto runCase(Case const& c, Options const& options) -> Result {
+    Result result{};
+    result.name = c.name;
+    Run const run = c.setup();
+    // Calibration runs double as the first warmup
+    size_t iterations = 1;
+    while (timeRun(run, iterations) < options.min_rep_seconds && iterations < (size_t{1} << 40)) {
+        iterations *= 2;
+    }
+    for (size_t i = 0; i < options.warmup; i++) {
+        timeRun(run, iterations);
+    }
+
+    result.ns_per_op.reserve(options.repetitions);
+    size_t const allocations_before = alloc_count::allocations.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < options.repetitions; i++) {
+        result.ns_per_op.push_back(timeRun(run, iterations) * 1e9 / static_cast<double>(iterations));
+    }
+    size_t const case_allocations = alloc_count::allocations.load(std::memory_order_relaxed) - allocations_before;
+    result.iterations = iterations;
+    result.allocs_per_op =
+        static_cast<double>(case_allocations) / static_cast<double>(iterations * options.repetitions);
+
+    std::vector<double> sorted = result.ns_per_op;
+    std::sort(sorted.begin(), sorted.end());
+    auto const n = static_cast<double>(sorted.size());
+    result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+    double squares = 0;
+    for (double x : sorted) {
+        squares += (x - result.mean) * (x - result.mean);
+    }
+    result.stddev = sorted.size() > 1 ? std::sqrt(squares / (n - 1)) : 0;
+    result.min = sorted.front();
+    result.max = sorted.back();
+    result.median = sorted.size() % 2 == 1 ? sorted[sorted.size() / 2]
+                                           : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+    return result;
+}
+
+inline void writeTable(std::ostream& out, std::vector<Result> const& results) {
+    size_t width = 4;
+    for (auto const& r : results) {
+        width = std::max(width, r.name.size());
+    }
+    out << std::string(width - 4, ' ') << "name     mean ns   stddev   median      min      max  allocs/op\n";
+    char line[160];
+    for (auto const& r : results) {
+        std::snprintf(line, sizeof(line), "%*s %11.2f %8.2f %8.2f %8.2f %8.2f %10.3f\n", static_cast<int>(width),
+                      r.name.c_str(), r.mean, r.stddev, r.median, r.min, r.max, r.allocs_per_op);
+        out << line;
+    }
+}
+
+inline void writeCsv(std::ostream& out, std::vector<Result> const& results) {
+    out << "name,iterations,repetitions,mean_ns,stddev_ns,median_ns,min_ns,max_ns,allocs_per_op\n";
+    for (auto const& r : results) {
+        out << r.name << ',' << r.iterations << ',' << r.ns_per_op.size() << ',' << r.mean << ',' << r.stddev << ','
+            << r.median << ',' << r.min << ',' << r.max << ',' << r.allocs_per_op << '\n';
+    }
+}
+
+// Case names are plain ASCII without quotes or backslashes, so they are written unescaped
+inline void writeJson(std::ostream& out, std::vector<Result> const& results, Options const& options) {
+    out << "{\n  \"warmup\": " << options.warmup << ",\n  \"repetitions\": " << options.repetitions
+        << ",\n  \"min_rep_seconds\": " << options.min_rep_seconds << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        Result const& r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev << ", \"median_ns\": " << r.median
+            << ", \"min_ns\": " << r.min << ", \"max_ns\": " << r.max << ", \"allocs_per_op\": " << r.allocs_per_op
+            << ", \"ns_per_op\": [";
+        for (size_t k = 0; k < r.ns_per_op.size(); k++) {
+            out << (k == 0 ? "" : ", ") << r.ns_per_op[k];
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace bench
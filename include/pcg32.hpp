@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// PCG32 (XSH RR variant, O'Neill 2014): 16 bytes of state, a 32-bit output per step, and the same sequence for a seed
+// on every platform. Meets UniformRandomBitGenerator so it can feed <random> distributions, but use bounded() where the
+// result has to be reproducible, the standard distributions are implementation defined.
+namespace rng {
+
+struct Pcg32 {
+    using result_type = uint32_t;
+
+    static constexpr uint64_t multiplier = 6364136223846793005ULL;
+    static constexpr uint64_t default_stream = 1442695040888963407ULL;
+
+    uint64_t state = 0;
+    uint64_t increment = default_stream;
+
+    constexpr Pcg32() = default;
+    constexpr explicit Pcg32(uint64_t seed, uint64_t stream = default_stream >> 1) : increment(stream << 1 | 1) {
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    static constexpr auto min() -> result_type { return 0; }
+    static constexpr auto max() -> result_type { return std::numeric_limits<result_type>::max(); }
+
+    constexpr auto operator()() -> result_type {
+        uint64_t const old = state;
+        state = old * multiplier + increment;
+        auto const xorshifted = static_cast<uint32_t>(((old >> 18U) ^ old) >> 27U);
+        auto const rotation = static_cast<uint32_t>(old >> 59U);
+        return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31U));
+    }
+
+    // Uniform in [0, bound) without modulo bias (Lemire's multiply and reject)
+    constexpr auto bounded(uint32_t bound) -> uint32_t {
+        uint64_t product = static_cast<uint64_t>((*this)()) * bound;
+        auto low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t const threshold = (0U - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>((*this)()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32U);
+    }
+
+    constexpr auto operator==(Pcg32 const&) const -> bool = default;
+};
+
+} // namespace rng
@@ -1,5 +1,6 @@
 #include "glm/glm.hpp"
 #include "raylib.h"
+#include "render.hpp"
 
 constexpr int screen_width = 1280;
 constexpr int screen_height = 800;
@@ -8,6 +9,9 @@ constexpr int rectangle_height = 120;
 constexpr int rectangle_width = 25;
 constexpr int padding = 10;
 
+// The centre line goes underneath the ball and paddles
+enum Layer : uint8_t { BackgroundLayer, ObjectLayer };
+
 inline auto toVector2(const glm::vec2& v) -> Vector2 { return Vector2{v[0], v[1]}; }
 
 struct Paddle {
@@ -15,9 +19,8 @@ struct Paddle {
     glm::vec2 dimension{rectangle_width, rectangle_height};
     float speed{10};
 
-    void draw() {
-        DrawRectangle(static_cast<int>(position[0]), static_cast<int>(position[1]), static_cast<int>(dimension[0]),
-                      static_cast<int>(dimension[1]), WHITE);
+    void draw(render::CommandBuffer& buffer) const {
+        buffer.rectangle(ObjectLayer, position[0], position[1], dimension[0], dimension[1], render::white);
     }
 
     void update() {
@@ -41,9 +44,8 @@ struct CpuPaddle {
     glm::vec2 dimension{rectangle_width, rectangle_height};
     float speed{6};
 
-    void draw() {
-        DrawRectangle(static_cast<int>(position[0]), static_cast<int>(position[1]), static_cast<int>(dimension[0]),
-                      static_cast<int>(dimension[1]), WHITE);
+    void draw(render::CommandBuffer& buffer) const {
+        buffer.rectangle(ObjectLayer, position[0], position[1], dimension[0], dimension[1], render::white);
     }
 
     void update(float ball_y) {
@@ -76,7 +78,9 @@ struct Ball {
         velocity[0] *= speed_choices[GetRandomValue(0, 1)];
         velocity[1] *= speed_choices[GetRandomValue(0, 1)];
     }
-    void draw() const { DrawCircleV(toVector2(position), radius, WHITE); }
+    void draw(render::CommandBuffer& buffer) const {
+        buffer.circle(ObjectLayer, position[0], position[1], radius, render::white);
+    }
     void updateEdge(int& player_score, int& cpu_score) {
         if (position[0] <= radius) {
             player_score++;
@@ -94,3 +98,18 @@ struct Ball {
         position += velocity;
     }
 };
+
+inline auto hitsPaddle(Ball const& ball, glm::vec2 position, glm::vec2 dimension) -> bool {
+    return CheckCollisionCircleRec(toVector2(ball.position), ball.radius,
+                                   Rectangle{position[0], position[1], dimension[0], dimension[1]});
+}
+
+// Each paddle the ball touches reverses its horizontal velocity
+inline void bounceOffPaddles(Ball& ball, Paddle const& player, CpuPaddle const& cpu_player) {
+    if (hitsPaddle(ball, player.position, player.dimension)) {
+        ball.velocity[0] = -ball.velocity[0];
+    }
+    if (hitsPaddle(ball, cpu_player.position, cpu_player.dimension)) {
+        ball.velocity[0] = -ball.velocity[0];
+    }
+}
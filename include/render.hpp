@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+// Retained draw command buffer shared by the games. Games encode their frame into a CommandBuffer, sort it, and hand it
+// to a backend: RaylibBackend (render_raylib.hpp) replays it on the GPU, RecordingBackend only counts, so encode cost
+// and draw call numbers can be measured without a window.
+namespace render {
+
+struct Color {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+constexpr Color white = {255, 255, 255, 255};
+constexpr Color dark_gray = {80, 80, 80, 255};
+
+// Filled primitives sort before outlines and text, so within a layer the order matches drawing shapes, then their
+// edges, then labels
+enum class Primitive : uint8_t {
+    Rectangle,
+    RoundedRectangle,
+    Circle,
+    Texture,
+    RectangleLines,
+    Line,
+    Text,
+    NumPrimitives
+};
+
+struct Command {
+    uint8_t layer;
+    Primitive primitive;
+    Color color;
+    uint32_t sequence;
+    // Rectangle-like primitives use x, y, width, height. Lines use (x, y) -> (width, height), circles use (x, y) as
+    // the centre.
+    float x;
+    float y;
+    float width;
+    float height;
+    // Roundness, line thickness, circle radius or font size
+    float param;
+    int segments;
+    // Texture id or offset into the text arena
+    uint32_t handle;
+
+    [[nodiscard]] auto sortKey() const -> uint64_t {
+        return static_cast<uint64_t>(layer) << 40 | static_cast<uint64_t>(primitive) << 32 |
+               static_cast<uint64_t>(color.r) << 24 | static_cast<uint64_t>(color.g) << 16 |
+               static_cast<uint64_t>(color.b) << 8 | color.a;
+    }
+};
+
+struct CommandBuffer {
+    std::vector<Command> commands;
+    std::vector<char> text_arena;
+
+    void clear() {
+        commands.clear();
+        text_arena.clear();
+    }
+
+    void push(Command command) {
+        command.sequence = static_cast<uint32_t>(commands.size());
+        commands.push_back(command);
+    }
+
+    void append(CommandBuffer const& other) {
+        for (Command command : other.commands) {
+            if (command.primitive == Primitive::Text) {
+                command.handle += static_cast<uint32_t>(text_arena.size());
+            }
+            push(command);
+        }
+        text_arena.insert(text_arena.end(), other.text_arena.begin(), other.text_arena.end());
+    }
+
+    // Groups commands by layer, then primitive, then colour, keeping submission order inside a group
+    void sort() {
+        std::sort(commands.begin(), commands.end(), [](Command const& a, Command const& b) {
+            uint64_t const key_a = a.sortKey();
+            uint64_t const key_b = b.sortKey();
+            return key_a != key_b ? key_a < key_b : a.sequence < b.sequence;
+        });
+    }
+
+    void rectangle(uint8_t layer, float x, float y, float width, float height, Color color) {
+        push(Command{layer, Primitive::Rectangle, color, 0, x, y, width, height, 0, 0, 0});
+    }
+
+    void roundedRectangle(uint8_t layer, float x, float y, float width, float height, float roundness, int segments,
+                          Color color) {
+        push(Command{layer, Primitive::RoundedRectangle, color, 0, x, y, width, height, roundness, segments, 0});
+    }
+
+    void rectangleLines(uint8_t layer, float x, float y, float width, float height, float thickness, Color color) {
+        push(Command{layer, Primitive::RectangleLines, color, 0, x, y, width, height, thickness, 0, 0});
+    }
+
+    void line(uint8_t layer, float x1, float y1, float x2, float y2, Color color) {
+        push(Command{layer, Primitive::Line, color, 0, x1, y1, x2, y2, 1, 0, 0});
+    }
+
+    void circle(uint8_t layer, float x, float y, float radius, Color color) {
+        push(Command{layer, Primitive::Circle, color, 0, x, y, 0, 0, radius, 0, 0});
+    }
+
+    void texture(uint8_t layer, uint32_t id, float x, float y, float width, float height, Color tint) {
+        push(Command{layer, Primitive::Texture, tint, 0, x, y, width, height, 0, 0, id});
+    }
+
+    void text(uint8_t layer, std::string_view str, float x, float y, float font_size, Color color) {
+        push(Command{layer, Primitive::Text, color, 0, x, y, 0, 0, font_size, 0,
+                     static_cast<uint32_t>(text_arena.size())});
+        text_arena.insert(text_arena.end(), str.begin(), str.end());
+        text_arena.push_back('\0');
+    }
+
+    // printf-style text, formatted straight into the arena
+    template <typename... Args>
+    void textf(uint8_t layer, float x, float y, float font_size, Color color, char const* format, Args... args) {
+        std::array<char, 64> formatted{};
+        int length = std::snprintf(formatted.data(), formatted.size(), format, args...);
+        text(layer, std::string_view{formatted.data(), static_cast<size_t>(std::clamp<int>(length, 0, 63))}, x, y,
+             font_size, color);
+    }
+
+    [[nodiscard]] auto textAt(Command const& command) const -> char const* { return &text_arena[command.handle]; }
+};
+
+// Null backend: records what would have been drawn
+struct RecordingBackend {
+    size_t frames = 0;
+    size_t draw_calls = 0;
+    // Runs of consecutive commands with the same primitive and colour, i.e. what a batching renderer would flush
+    size_t batches = 0;
+    std::array<size_t, static_cast<size_t>(Primitive::NumPrimitives)> per_primitive{};
+
+    void submit(CommandBuffer const& buffer) {
+        Command const* previous = nullptr;
+        for (Command const& command : buffer.commands) {
+            draw_calls++;
+            per_primitive[static_cast<size_t>(command.primitive)]++;
+            if (previous == nullptr || previous->primitive != command.primitive ||
+                previous->sortKey() != command.sortKey()) {
+                batches++;
+            }
+            previous = &command;
+        }
+    }
+
+    void endFrame() { frames++; }
+};
+
+} // namespace render
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "raylib.h"
+#include "render.hpp"
+#include "trace.hpp"
+
+namespace render {
+
+inline auto toRaylib(Color color) -> ::Color { return ::Color{color.r, color.g, color.b, color.a}; }
+
+// Replays a sorted command buffer through raylib's immediate mode calls
+struct RaylibBackend {
+    static void submit(CommandBuffer const& buffer) {
+        TRACE_SCOPE("RaylibBackend::submit");
+        for (Command const& command : buffer.commands) {
+            ::Color const color = toRaylib(command.color);
+            Rectangle const rect{command.x, command.y, command.width, command.height};
+            switch (command.primitive) {
+            case Primitive::Rectangle:
+                DrawRectangleRec(rect, color);
+                break;
+            case Primitive::RoundedRectangle:
+                DrawRectangleRounded(rect, command.param, command.segments, color);
+                break;
+            case Primitive::Circle:
+                DrawCircleV(Vector2{command.x, command.y}, command.param, color);
+                break;
+            case Primitive::Texture:
+                DrawTexture(Texture2D{command.handle, static_cast<int>(command.width), static_cast<int>(command.height),
+                                      1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8},
+                            static_cast<int>(command.x), static_cast<int>(command.y), color);
+                break;
+            case Primitive::RectangleLines:
+                DrawRectangleLinesEx(rect, command.param, color);
+                break;
+            case Primitive::Line:
+                DrawLine(static_cast<int>(command.x), static_cast<int>(command.y), static_cast<int>(command.width),
+                         static_cast<int>(command.height), color);
+                break;
+            case Primitive::Text:
+                DrawText(buffer.textAt(command), static_cast<int>(command.x), static_cast<int>(command.y),
+                         static_cast<int>(command.param), color);
+                break;
+            case Primitive::NumPrimitives:
+                break;
+            }
+        }
+    }
+};
+
+} // namespace render
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "asset_bundle.hpp"
+#include "asset_bundle_raylib.hpp"
+#include "raylib.h"
+#include "render.hpp"
+#include "snake_logic.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace snake {
+
+constexpr int screen_width = 750;
+constexpr int screen_height = 750;
+
+constexpr render::Color green = {173, 204, 96, 255};
+constexpr render::Color dark_green = {43, 51, 24, 255};
+
+constexpr render::Color food_red = {190, 33, 55, 255};
+
+// Pixels per cell at the default zoom, and the default grid, which fits the view at that zoom
+constexpr int cell_size = 30;
+constexpr int cell_count = 25;
+constexpr int offset = 75;
+// Where the asset files are when there is no bundle next to the executable, relative to the working directory
+constexpr char const* loose_assets = "assets/";
+// Side of the square view onto the grid in pixels
+constexpr int view_pixels = cell_size * cell_count;
+// Zoom steps in pixels per cell. Below rounded_min_pixels segments are drawn as plain rectangles, merged along rows.
+constexpr std::array zoom_levels = {30, 15, 10, 6, 3, 2, 1};
+constexpr int rounded_min_pixels = 10;
+
+// The part of the grid on screen: the top left visible cell and the pixels per cell. Grids up to thousands of cells per
+// side scroll with the head.
+struct Camera {
+    ivec2 origin{};
+    size_t zoom = 0;
+
+    [[nodiscard]] auto cellPixels() const -> int { return zoom_levels[zoom]; }
+    [[nodiscard]] auto visibleCells() const -> int { return view_pixels / cellPixels(); }
+
+    // Centres the view on `head` without showing anything past the edges of the grid
+    void follow(ivec2 head, ivec2 grid_size) {
+        int const half = visibleCells() / 2;
+        origin = {std::clamp(head.x - half, 0, std::max(0, grid_size.x - visibleCells())),
+                  std::clamp(head.y - half, 0, std::max(0, grid_size.y - visibleCells()))};
+    }
+
+    void zoomIn() { zoom = zoom > 0 ? zoom - 1 : 0; }
+    void zoomOut() { zoom = std::min(zoom + 1, zoom_levels.size() - 1); }
+
+    // One past the last visible cell
+    [[nodiscard]] auto end(ivec2 grid_size) const -> ivec2 {
+        return {std::min(origin.x + visibleCells(), grid_size.x), std::min(origin.y + visibleCells(), grid_size.y)};
+    }
+    [[nodiscard]] auto visible(ivec2 cell, ivec2 grid_size) const -> bool {
+        ivec2 const last = end(grid_size);
+        return cell.x >= origin.x && cell.y >= origin.y && cell.x < last.x && cell.y < last.y;
+    }
+    [[nodiscard]] auto screenX(int x) const -> float {
+        return static_cast<float>(offset + (x - origin.x) * cellPixels());
+    }
+    [[nodiscard]] auto screenY(int y) const -> float {
+        return static_cast<float>(offset + (y - origin.y) * cellPixels());
+    }
+};
+
+// Draws the segments in view by scanning the visible cells of the occupancy grid, so the cost depends on the view and
+// not on the length of the snake. Empty chunks are skipped whole. Zoomed out, each row of adjacent segments is one
+// rectangle, and full chunks extend it without reading their cells.
+inline void drawSnake(render::CommandBuffer& buffer, Snake const& snake, Camera const& camera) {
+    TRACE_SCOPE("drawSnake");
+    OccupancyGrid const& grid = snake.occupancy;
+    ivec2 const end = camera.end(grid.size);
+    auto const pixels = static_cast<float>(camera.cellPixels());
+    bool const rounded = camera.cellPixels() >= rounded_min_pixels;
+    constexpr int full_chunk = OccupancyGrid::chunk_size * OccupancyGrid::chunk_size;
+    for (int y = camera.origin.y; y < end.y; y++) {
+        // Start of the run of segments being merged, if any
+        int run_start = -1;
+        auto flush = [&](int run_end) {
+            if (run_start >= 0) {
+                buffer.rectangle(0, camera.screenX(run_start), camera.screenY(y),
+                                 static_cast<float>(run_end - run_start) * pixels, pixels, dark_green);
+                run_start = -1;
+            }
+        };
+        for (int x = camera.origin.x; x < end.x; x++) {
+            // The last visible cell of this chunk's row, the loop steps into the next chunk from there
+            int const chunk_last = std::min(end.x, (x / OccupancyGrid::chunk_size + 1) * OccupancyGrid::chunk_size) - 1;
+            int const chunk_count = grid.chunkCount({x, y});
+            if (chunk_count == 0) {
+                flush(x);
+                x = chunk_last;
+                continue;
+            }
+            if (!rounded && chunk_count == full_chunk) {
+                run_start = run_start < 0 ? x : run_start;
+                x = chunk_last;
+                continue;
+            }
+            if (!grid.occupied({x, y})) {
+                flush(x);
+            } else if (rounded) {
+                buffer.roundedRectangle(0, camera.screenX(x), camera.screenY(y), pixels, pixels, 0.5, 6, dark_green);
+            } else if (run_start < 0) {
+                run_start = x;
+            }
+        }
+        flush(end.x);
+    }
+}
+
+struct Food {
+    Texture2D texture{};
+
+    explicit Food(assets::Bundle const& bundle) : texture(assets::loadTexture(bundle, loose_assets, "food.png")) {}
+    ~Food() { UnloadTexture(texture); }
+    Food(const Food&) = default;
+    Food(Food&&) = delete;
+    Food& operator=(const Food&) = default;
+    Food& operator=(Food&&) = delete;
+
+    // The texture at the default zoom, a dot otherwise
+    void draw(render::CommandBuffer& buffer, ivec2 position, Camera const& camera) const {
+        float const x = camera.screenX(position[0]);
+        float const y = camera.screenY(position[1]);
+        if (camera.cellPixels() == texture.width) {
+            buffer.texture(0, texture.id, x, y, static_cast<float>(texture.width), static_cast<float>(texture.height),
+                           render::white);
+        } else {
+            auto const pixels = static_cast<float>(camera.cellPixels());
+            buffer.roundedRectangle(0, x, y, pixels, pixels, 1, 6, food_red);
+        }
+    }
+};
+
+// The windowed game: a Logic with the food texture and the sounds
+struct Game {
+    Logic logic;
+    Camera camera;
+    Food food;
+    Sound eat_sound{};
+    Sound wall_sound{};
+
+    // Assets missing from the bundle are decoded from the loose files
+    Game(ivec2 grid_size, uint64_t seed, assets::Bundle const& bundle) : logic(grid_size, seed), food(bundle) {
+        InitAudioDevice();
+        eat_sound = assets::loadSound(bundle, loose_assets, "eat.mp3");
+        wall_sound = assets::loadSound(bundle, loose_assets, "wall.mp3");
+    }
+
+    Game(const Game&) = default;
+    Game(Game&&) = delete;
+    Game& operator=(const Game&) = default;
+    Game& operator=(Game&&) = delete;
+    ~Game() {
+        UnloadSound(eat_sound);
+        UnloadSound(wall_sound);
+        CloseAudioDevice();
+    }
+
+    void draw(render::CommandBuffer& buffer) const {
+        TRACE_SCOPE("Game::draw");
+        // Smaller than the view when the whole grid fits
+        ivec2 const view = (camera.end(logic.size()) - camera.origin) * camera.cellPixels();
+        buffer.rectangleLines(0, offset - 5, offset - 5, static_cast<float>(view.x + 10),
+                              static_cast<float>(view.y + 10), 5, dark_green);
+        buffer.text(0, "Retro Snake", offset - 5, 20, 40, dark_green);
+        buffer.textf(0, offset - 5, offset + view_pixels + 10, 40, dark_green, "%i", logic.score);
+        if (logic.won) {
+            buffer.text(0, "You win!", offset + view_pixels - 160, offset + view_pixels + 10, 40, dark_green);
+        }
+        if (camera.visible(logic.food, logic.size())) {
+            food.draw(buffer, logic.food, camera);
+        }
+        drawSnake(buffer, logic.snake, camera);
+        buffer.sort();
+    }
+
+    // One tick, with its sound
+    auto update() -> Event {
+        TRACE_SCOPE("Game::update");
+        Event const event = logic.step();
+        switch (event) {
+        case Event::Ate:
+        case Event::Won:
+            PlaySound(eat_sound);
+            break;
+        case Event::Died:
+            PlaySound(wall_sound);
+            break;
+        default:
+            break;
+        }
+        camera.follow(logic.snake.body.front(), logic.size());
+        return event;
+    }
+};
+
+} // namespace snake
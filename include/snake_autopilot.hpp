@@ -0,0 +1,385 @@
+#pragma once
+
+#include "snake_logic.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Plays snake on its own. Every tick it searches a shortest path to the food with A* and takes its first step when that
+// is safe, otherwise it follows a Hamiltonian cycle of the grid, which visits every cell and so can finish the board.
+//
+// Once the body lies along the cycle in order the snake follows it, stepping off only where that keeps the order and
+// leaves room ahead of the tail, and never once half the board is snake (shortcuts as in John Tapsell's snake AI).
+// Without a cycle, or while the body is out of cycle order, the food's path step is taken if a flood fill from it still
+// reaches as many cells as the snake is long, and otherwise the step into the largest open area.
+//
+// Grids with an odd number of cells have no Hamiltonian cycle, the one used there leaves out a corner, and no player
+// can always finish them. The last meal has to come on the tick after another one, while the tail stays put: eaten on
+// any other tick it frees the tail cell, and reaching that next would close a cycle over the whole grid. So the last
+// two free cells are eaten on consecutive ticks in whichever order the food lands on them, and being ready for either
+// order needs the head and both cells to all touch each other, which grid cells never do. At most half of the games can
+// be won. The autopilot wins about a fifth, the others end one cell short of the board.
+namespace snake {
+
+constexpr std::array<ivec2, 4> directions = {ivec2{1, 0}, ivec2{0, 1}, ivec2{-1, 0}, ivec2{0, -1}};
+
+struct Autopilot {
+    ivec2 size;
+    uint32_t num_cells;
+    // Cell indices in cycle order, empty when there is no cycle
+    std::vector<uint32_t> cycle;
+    // Position of each cell on the cycle, in the direction currently followed
+    std::vector<uint32_t> cycle_pos;
+    // On odd grids the cycle leaves out the corner (0, 0). The snake goes through it in place of (1, 1), between the
+    // corner's two neighbors, when the food is there: the corner takes the position of (1, 1).
+    std::optional<uint32_t> corner;
+    uint32_t corner_alias = 0;
+    bool reversed = false;
+    // The body lies along the cycle in order
+    bool ordered = false;
+    size_t last_length = 0;
+
+    // Search scratch. A cell's entries are valid when its stamp is the current search's, so nothing is cleared per
+    // tick. The lists grow to the largest search seen and are reused, instead of being reserved for the whole grid.
+    std::vector<uint32_t> stamps;
+    uint32_t search = 0;
+    std::vector<uint32_t> costs;
+    std::vector<uint32_t> parents;
+    std::vector<std::pair<uint32_t, uint32_t>> open;
+    std::vector<uint32_t> stack;
+    // The last path found, first step first
+    std::vector<ivec2> path;
+    // Where the snake would be after following that path, made on the first check
+    std::optional<Snake> future;
+
+    explicit Autopilot(ivec2 grid_size)
+        : size(grid_size), num_cells(static_cast<uint32_t>(grid_size.x * grid_size.y)), cycle_pos(num_cells),
+          stamps(num_cells), costs(num_cells), parents(num_cells) {
+        buildCycle();
+    }
+
+    [[nodiscard]] auto index(ivec2 cell) const -> uint32_t { return static_cast<uint32_t>(cell.y * size.x + cell.x); }
+    [[nodiscard]] auto cellAt(uint32_t i) const -> ivec2 {
+        return {static_cast<int>(i) % size.x, static_cast<int>(i) / size.x};
+    }
+    [[nodiscard]] auto inside(ivec2 cell) const -> bool {
+        return cell.x >= 0 && cell.x < size.x && cell.y >= 0 && cell.y < size.y;
+    }
+
+    // Row 0 left to right, then back and forth over columns 1.. row by row, and up column 0. Needs an even number of
+    // rows, otherwise the same runs over columns.
+    void buildCycle() {
+        if (size.x < 3 || size.y < 3) {
+            return;
+        }
+        if (size.x % 2 != 0 && size.y % 2 != 0) {
+            buildOddCycle();
+            return;
+        }
+        bool const transpose = size.y % 2 != 0;
+        int const width = transpose ? size.y : size.x;
+        int const height = transpose ? size.x : size.y;
+        auto add = [&](int x, int y) { cycle.push_back(transpose ? index({y, x}) : index({x, y})); };
+        for (int x = 0; x < width; x++) {
+            add(x, 0);
+        }
+        for (int y = 1; y < height; y++) {
+            for (int i = 1; i < width; i++) {
+                add(y % 2 != 0 ? width - i : i, y);
+            }
+        }
+        for (int y = height - 1; y > 0; y--) {
+            add(0, y);
+        }
+        orient(false);
+    }
+
+    // Every cell but the corner: down column 0 from (0, 1), back and forth over rows h-1 to 2, up and down columns
+    // w-1 to 2 in rows 1 and 0, then (1, 0), (1, 1) and back to (0, 1)
+    void buildOddCycle() {
+        auto add = [&](int x, int y) { cycle.push_back(index({x, y})); };
+        for (int y = 1; y < size.y; y++) {
+            add(0, y);
+        }
+        for (int y = size.y - 1; y >= 2; y--) {
+            for (int i = 1; i < size.x; i++) {
+                add((size.y - 1 - y) % 2 == 0 ? i : size.x - i, y);
+            }
+        }
+        for (int x = size.x - 1; x >= 2; x--) {
+            bool const down = (size.x - 1 - x) % 2 == 0;
+            add(x, down ? 1 : 0);
+            add(x, down ? 0 : 1);
+        }
+        add(1, 0);
+        add(1, 1);
+        corner = index({0, 0});
+        corner_alias = index({1, 1});
+        orient(false);
+    }
+
+    void orient(bool reverse) {
+        reversed = reverse;
+        auto const length = static_cast<uint32_t>(cycle.size());
+        for (uint32_t i = 0; i < length; i++) {
+            cycle_pos[cycle[i]] = reverse ? length - 1 - i : i;
+        }
+        if (corner.has_value()) {
+            cycle_pos[corner.value()] = cycle_pos[corner_alias];
+        }
+    }
+
+    // Steps along the cycle from a to b
+    [[nodiscard]] auto cycleDistance(uint32_t a, uint32_t b) const -> uint32_t {
+        auto const length = static_cast<uint32_t>(cycle.size());
+        return (cycle_pos[b] + length - cycle_pos[a]) % length;
+    }
+
+    [[nodiscard]] auto cycleNext(uint32_t cell) const -> uint32_t {
+        auto const length = static_cast<uint32_t>(cycle.size());
+        uint32_t const next = (cycle_pos[cell] + 1) % length;
+        return cycle[reversed ? length - 1 - next : next];
+    }
+
+    // Going from the tail to the head, each segment is further along the cycle and the whole body spans less than a lap
+    [[nodiscard]] auto inCycleOrder(Snake const& snake) const -> bool {
+        uint64_t span = 0;
+        for (size_t i = 0; i + 1 < snake.body.size(); i++) {
+            uint32_t const step = cycleDistance(index(snake.body[i + 1]), index(snake.body[i]));
+            if (step == 0) {
+                return false;
+            }
+            span += step;
+        }
+        return span < cycle.size();
+    }
+
+    // Follows the cycle in whichever direction the body lies along, when it does
+    void updateOrder(Snake const& snake) {
+        if (cycle.empty() || ordered) {
+            return;
+        }
+        for (bool reverse : {false, true}) {
+            orient(reverse);
+            if (inCycleOrder(snake)) {
+                ordered = true;
+                return;
+            }
+        }
+        orient(false);
+    }
+
+    [[nodiscard]] auto passable(Snake const& snake, ivec2 cell) const -> bool {
+        return inside(cell) && (!snake.occupies(cell) || (cell == snake.body.back() && !snake.add_segment));
+    }
+
+    // Shortest path from the head to `target` through free cells into `path`, the tail counting as free when it moves
+    // away this tick. Returns the first step.
+    auto findPath(Snake const& snake, ivec2 target) -> std::optional<ivec2> {
+        search++;
+        ivec2 const head = snake.body.front();
+        auto heuristic = [target](ivec2 cell) {
+            return static_cast<uint32_t>(std::abs(cell.x - target.x) + std::abs(cell.y - target.y));
+        };
+        open.clear();
+        stamps[index(head)] = search;
+        costs[index(head)] = 0;
+        parents[index(head)] = index(head);
+        open.emplace_back(heuristic(head), index(head));
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), std::greater<>{});
+            auto const [estimate, current] = open.back();
+            open.pop_back();
+            ivec2 const cell = cellAt(current);
+            if (estimate != costs[current] + heuristic(cell)) {
+                continue;
+            }
+            if (cell == target) {
+                path.clear();
+                for (uint32_t step = current; step != index(head); step = parents[step]) {
+                    path.push_back(cellAt(step));
+                }
+                std::reverse(path.begin(), path.end());
+                return path.front();
+            }
+            for (ivec2 direction : directions) {
+                ivec2 const next = cell + direction;
+                if (!passable(snake, next)) {
+                    continue;
+                }
+                uint32_t const i = index(next);
+                uint32_t const cost = costs[current] + 1;
+                if (stamps[i] != search || cost < costs[i]) {
+                    stamps[i] = search;
+                    costs[i] = cost;
+                    parents[i] = current;
+                    open.emplace_back(cost + heuristic(next), i);
+                    std::push_heap(open.begin(), open.end(), std::greater<>{});
+                }
+            }
+        }
+        return {};
+    }
+
+    // Cells reachable from `start` through free cells, stopping once `enough` are found
+    auto floodFill(Snake const& snake, ivec2 start, size_t enough) -> size_t {
+        search++;
+        stack.clear();
+        stack.push_back(index(start));
+        stamps[index(start)] = search;
+        size_t reached = 0;
+        while (!stack.empty() && reached < enough) {
+            ivec2 const cell = cellAt(stack.back());
+            stack.pop_back();
+            reached++;
+            for (ivec2 direction : directions) {
+                ivec2 const next = cell + direction;
+                if (passable(snake, next) && stamps[index(next)] != search) {
+                    stamps[index(next)] = search;
+                    stack.push_back(index(next));
+                }
+            }
+        }
+        return reached;
+    }
+
+    // Direction for the next tick
+    auto next(Logic const& logic) -> ivec2 {
+        Snake const& snake = logic.snake;
+        if (snake.body.size() < last_length) {
+            // A new game
+            ordered = false;
+        }
+        last_length = snake.body.size();
+        updateOrder(snake);
+        ivec2 const head = snake.body.front();
+        std::optional<ivec2> const target = ordered ? shortcut(snake, logic.food) : openStep(snake, logic.food);
+        return target.value_or(head + snake.direction) - head;
+    }
+
+    // The food's path step or the neighbor furthest along the cycle short of the food, if either keeps the body in
+    // cycle order with room to spare, otherwise the next cell of the cycle
+    auto shortcut(Snake const& snake, ivec2 food) -> ivec2 {
+        uint32_t const head = index(snake.body.front());
+        uint32_t const to_tail = cycleDistance(head, index(snake.body.back()));
+        uint32_t const to_food = cycleDistance(head, index(food));
+        auto const free_cells = static_cast<int>(num_cells - snake.body.size());
+        int available = static_cast<int>(to_tail) - (snake.add_segment ? 1 : 0) - 3;
+        if (free_cells < static_cast<int>(num_cells) / 2) {
+            available = 0;
+        } else if (to_food < to_tail) {
+            available -= 1;
+            if (static_cast<int>(to_tail - to_food) * 4 > free_cells) {
+                available -= 10;
+            }
+        }
+        auto allowed = [&](ivec2 cell) {
+            if (!inside(cell) || snake.occupies(cell)) {
+                return false;
+            }
+            auto const distance = static_cast<int>(cycleDistance(head, index(cell)));
+            return distance <= available && distance <= static_cast<int>(to_food);
+        };
+        // The last free cell wins the game wherever it is
+        if (free_cells == 1 && std::abs(food.x - snake.body.front().x) + std::abs(food.y - snake.body.front().y) == 1) {
+            return food;
+        }
+        // Into the corner instead of its alias for the food, if the cell after the alias is free by the time the
+        // snake has grown
+        if (corner.has_value() && index(food) == corner.value() && cycleNext(head) == corner_alias &&
+            static_cast<int>(to_tail) - (snake.add_segment ? 1 : 0) >= 2) {
+            return food;
+        }
+        if (available <= 1) {
+            return cellAt(cycleNext(head));
+        }
+        std::optional<ivec2> const step = findPath(snake, food);
+        if (step.has_value() && allowed(step.value())) {
+            return step.value();
+        }
+        std::optional<ivec2> best;
+        uint32_t best_distance = 0;
+        for (ivec2 direction : directions) {
+            ivec2 const cell = snake.body.front() + direction;
+            if (allowed(cell) && cycleDistance(head, index(cell)) > best_distance) {
+                best = cell;
+                best_distance = cycleDistance(head, index(cell));
+            }
+        }
+        return best.value_or(cellAt(cycleNext(head)));
+    }
+
+    // Follows `path` with a copy of the snake, eating at its end, and checks that the head can then still reach the
+    // tail, so the snake cannot have shut itself in
+    auto safeToFollow(Snake const& snake) -> bool {
+        if (!future.has_value()) {
+            future.emplace(snake);
+        } else {
+            *future = snake;
+        }
+        for (ivec2 cell : path) {
+            future->pushFront(cell);
+            if (future->add_segment) {
+                future->add_segment = false;
+            } else {
+                future->popBack();
+            }
+        }
+        future->add_segment = true;
+        ivec2 const tail = future->body.back();
+        search++;
+        stack.clear();
+        stack.push_back(index(future->body.front()));
+        stamps[stack.back()] = search;
+        while (!stack.empty()) {
+            ivec2 const cell = cellAt(stack.back());
+            stack.pop_back();
+            for (ivec2 direction : directions) {
+                ivec2 const next = cell + direction;
+                if (next == tail) {
+                    return true;
+                }
+                if (inside(next) && !future->occupies(next) && stamps[index(next)] != search) {
+                    stamps[index(next)] = search;
+                    stack.push_back(index(next));
+                }
+            }
+        }
+        return false;
+    }
+
+    // The food's path step if the snake can still reach its tail after eating, otherwise a step toward the tail, and
+    // failing that the step into the largest open area
+    auto openStep(Snake const& snake, ivec2 food) -> std::optional<ivec2> {
+        std::optional<ivec2> const step = findPath(snake, food);
+        if (step.has_value() && safeToFollow(snake)) {
+            return step;
+        }
+        if (std::optional<ivec2> const to_tail = findPath(snake, snake.body.back()); to_tail.has_value()) {
+            return to_tail;
+        }
+        size_t const length = snake.body.size();
+        std::optional<ivec2> best;
+        size_t best_area = 0;
+        for (ivec2 direction : directions) {
+            ivec2 const cell = snake.body.front() + direction;
+            if (!passable(snake, cell)) {
+                continue;
+            }
+            size_t const area = floodFill(snake, cell, length);
+            if (area > best_area) {
+                best = cell;
+                best_area = area;
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace snake
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "snake_logic.hpp"
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+
+// Turn input for snake. Key presses are queued with the time they happened and the game takes one per tick, so quick
+// two-key turns both land instead of the second overwriting the first between ticks.
+namespace snake {
+
+// A turn key press and when it happened, on the same clock as Ticker::update
+struct TurnEvent {
+    double time;
+    ivec2 direction;
+};
+
+// Turns waiting for their tick, oldest first. Presses beyond the capacity are dropped, nobody means more than a few
+// turns ahead.
+struct TurnQueue {
+    static constexpr size_t capacity = 4;
+    std::array<TurnEvent, capacity> events{};
+    size_t head = 0;
+    size_t size = 0;
+
+    auto push(TurnEvent const& event) -> bool {
+        if (size == capacity) {
+            return false;
+        }
+        events[(head + size) % capacity] = event;
+        size++;
+        return true;
+    }
+
+    auto pop() -> std::optional<TurnEvent> {
+        if (size == 0) {
+            return {};
+        }
+        TurnEvent event = events[head];
+        head = (head + 1) % capacity;
+        size--;
+        return event;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return size == 0; }
+    [[nodiscard]] auto front() const -> TurnEvent const& { return events[head]; }
+    [[nodiscard]] auto back() const -> TurnEvent const& { return events[(head + size - 1) % capacity]; }
+
+    void clear() {
+        head = 0;
+        size = 0;
+    }
+};
+
+// Steps a game every `interval` seconds, handing each tick the oldest queued turn
+struct Ticker {
+    double interval = 0.2;
+    // Tick on the first update after a turn is queued instead of at the next boundary, and count the following
+    // intervals from there. Ticks stay at least half an interval apart, so pressing keys can't more than double the
+    // speed of the snake.
+    bool apply_on_next_frame = false;
+    TurnQueue turns;
+    double next_tick = interval;
+    double last_tick = -std::numeric_limits<double>::infinity();
+
+    // Queues a turn unless it reverses the direction the snake will be heading when the turn comes up: the last
+    // queued turn, or `direction` when none are queued. Returns whether it was queued. A press in the heading is kept,
+    // after a game over it is what starts the next game.
+    auto press(TurnEvent const& event, ivec2 direction) -> bool {
+        ivec2 const heading = turns.empty() ? direction : turns.back().direction;
+        if (event.direction == -heading) {
+            return false;
+        }
+        return turns.push(event);
+    }
+
+    // Runs the tick due by `now`, if any. `tick(turn)` steers with the turn when there is one, steps the game and
+    // returns the step's Event. Turns queued before a game ends are dropped with it.
+    template <typename Tick> void update(double now, Tick&& tick) {
+        bool const early = apply_on_next_frame && !turns.empty() && turns.front().time <= now &&
+                           now - last_tick >= interval / 2;
+        if (now < next_tick && !early) {
+            return;
+        }
+        std::optional<ivec2> turn;
+        if (std::optional<TurnEvent> event = turns.pop()) {
+            turn = event->direction;
+        }
+        Event const event = tick(turn);
+        if (event == Event::Died || event == Event::Won) {
+            turns.clear();
+        }
+        last_tick = now;
+        // Fixed boundaries, unless a slow frame or an early tick left them behind
+        next_tick = now < next_tick ? now + interval : next_tick + interval;
+        if (next_tick <= now) {
+            next_tick = now + interval;
+        }
+    }
+};
+
+} // namespace snake
@@ -0,0 +1,311 @@
+#pragma once
+
+#include "pcg32.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <glm/glm.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+// The rules of snake without a window, textures or sounds, so any number of games can run headless and in parallel.
+// snake.h draws a Logic and plays its events.
+namespace snake {
+
+using glm::ivec2;
+
+inline auto elementInDeque(ivec2 el, std::deque<ivec2> const& deq) -> bool {
+    return std::any_of(deq.begin(), deq.end(), [el](ivec2 x) { return el == x; });
+};
+
+// Number of snake segments on each cell of the grid, and an index of the empty cells to spawn food on. Cells outside
+// the grid are never occupied. A count of two only happens for the tick where the head runs into the body.
+struct OccupancyGrid {
+    // Side of the square blocks of cells counted together, a power of two
+    static constexpr int chunk_size = 16;
+
+    ivec2 size;
+    std::vector<uint8_t> counts;
+    // The empty cells in no particular order, and where each empty cell is in that list
+    std::vector<uint32_t> free_cells;
+    std::vector<uint32_t> free_slots;
+    size_t num_free = 0;
+    // Occupied cells in each chunk, row major, so drawing a big grid can skip empty blocks without reading their cells
+    ivec2 chunks;
+    std::vector<uint16_t> chunk_counts;
+
+    explicit OccupancyGrid(ivec2 grid_size)
+        : size(grid_size), counts(numCells()), free_cells(numCells()), free_slots(numCells()),
+          chunks((grid_size.x + chunk_size - 1) / chunk_size, (grid_size.y + chunk_size - 1) / chunk_size),
+          chunk_counts(static_cast<size_t>(chunks.x) * static_cast<size_t>(chunks.y)) {
+        clear();
+    }
+
+    [[nodiscard]] auto numCells() const -> size_t { return static_cast<size_t>(size.x) * static_cast<size_t>(size.y); }
+    [[nodiscard]] auto inside(ivec2 cell) const -> bool {
+        return cell.x >= 0 && cell.x < size.x && cell.y >= 0 && cell.y < size.y;
+    }
+    [[nodiscard]] auto index(ivec2 cell) const -> size_t {
+        return static_cast<size_t>(cell.y) * static_cast<size_t>(size.x) + static_cast<size_t>(cell.x);
+    }
+    [[nodiscard]] auto cellAt(size_t i) const -> ivec2 {
+        return {static_cast<int>(i % static_cast<size_t>(size.x)), static_cast<int>(i / static_cast<size_t>(size.x))};
+    }
+
+    [[nodiscard]] auto count(ivec2 cell) const -> int { return inside(cell) ? counts[index(cell)] : 0; }
+    [[nodiscard]] auto occupied(ivec2 cell) const -> bool { return count(cell) > 0; }
+
+    // Occupied cells in the chunk containing `cell`, which is inside the grid
+    [[nodiscard]] auto chunkIndex(ivec2 cell) const -> size_t {
+        return static_cast<size_t>(cell.y / chunk_size) * static_cast<size_t>(chunks.x) +
+               static_cast<size_t>(cell.x / chunk_size);
+    }
+    [[nodiscard]] auto chunkCount(ivec2 cell) const -> int { return chunk_counts[chunkIndex(cell)]; }
+
+    // The i-th empty cell, i < num_free
+    [[nodiscard]] auto freeCell(size_t i) const -> ivec2 { return cellAt(free_cells[i]); }
+
+    void add(ivec2 cell) {
+        if (inside(cell) && counts[index(cell)]++ == 0) {
+            // Swap remove from the free list
+            uint32_t const slot = free_slots[index(cell)];
+            uint32_t const last = free_cells[--num_free];
+            free_cells[slot] = last;
+            free_slots[last] = slot;
+            chunk_counts[chunkIndex(cell)]++;
+        }
+    }
+    void remove(ivec2 cell) {
+        if (inside(cell) && --counts[index(cell)] == 0) {
+            free_cells[num_free] = static_cast<uint32_t>(index(cell));
+            free_slots[index(cell)] = static_cast<uint32_t>(num_free);
+            num_free++;
+            chunk_counts[chunkIndex(cell)]--;
+        }
+    }
+    void clear() {
+        std::fill(counts.begin(), counts.end(), 0);
+        std::fill(chunk_counts.begin(), chunk_counts.end(), 0);
+        for (size_t i = 0; i < numCells(); i++) {
+            free_cells[i] = static_cast<uint32_t>(i);
+            free_slots[i] = static_cast<uint32_t>(i);
+        }
+        num_free = numCells();
+    }
+};
+
+// Cell coordinates packed for the snake body, grids stay well within 16 bits
+struct PackedCell {
+    int16_t x;
+    int16_t y;
+};
+
+// Body segments head first in a ring allocated up front, so a move is an index update and never allocates. The ring
+// holds exactly the capacity asked for, indices wrap with a compare instead of a power-of-two mask so that a grid with
+// a power-of-two number of cells doesn't double it.
+struct RingBody {
+    std::vector<PackedCell> cells;
+    size_t head = 0;
+    size_t length = 0;
+
+    struct Iterator {
+        RingBody const* body;
+        size_t i;
+
+        auto operator*() const -> ivec2 { return (*body)[i]; }
+        auto operator++() -> Iterator& {
+            i++;
+            return *this;
+        }
+        auto operator==(Iterator const&) const -> bool = default;
+    };
+
+    explicit RingBody(size_t capacity) : cells(std::max<size_t>(capacity, 1)) {}
+
+    [[nodiscard]] auto capacity() const -> size_t { return cells.size(); }
+    [[nodiscard]] auto size() const -> size_t { return length; }
+    [[nodiscard]] auto operator[](size_t i) const -> ivec2 {
+        size_t const slot = head + i;
+        PackedCell const cell = cells[slot < cells.size() ? slot : slot - cells.size()];
+        return {cell.x, cell.y};
+    }
+    [[nodiscard]] auto front() const -> ivec2 { return (*this)[0]; }
+    [[nodiscard]] auto back() const -> ivec2 { return (*this)[length - 1]; }
+    [[nodiscard]] auto begin() const -> Iterator { return {this, 0}; }
+    [[nodiscard]] auto end() const -> Iterator { return {this, length}; }
+
+    void push_front(ivec2 cell) {
+        assert(length < capacity());
+        head = (head == 0 ? cells.size() : head) - 1;
+        cells[head] = PackedCell{static_cast<int16_t>(cell.x), static_cast<int16_t>(cell.y)};
+        length++;
+    }
+    void pop_back() {
+        assert(length > 0);
+        length--;
+    }
+    void clear() { length = 0; }
+};
+
+// A body of `length` cells winding row by row from the top left corner, head first, so a long snake can be set up
+// without it touching itself. The head is the last cell of the winding and moves on along its row.
+inline auto windingBody(ivec2 grid_size, size_t length) -> std::vector<ivec2> {
+    length = std::min(length, static_cast<size_t>(grid_size.x) * static_cast<size_t>(grid_size.y));
+    std::vector<ivec2> body(length);
+    for (size_t i = 0; i < length; i++) {
+        auto const row = static_cast<int>(i / static_cast<size_t>(grid_size.x));
+        auto const along = static_cast<int>(i % static_cast<size_t>(grid_size.x));
+        body[length - 1 - i] = {row % 2 == 0 ? along : grid_size.x - 1 - along, row};
+    }
+    return body;
+}
+
+// The body and the occupancy grid change together, through pushFront, popBack and setBody
+struct Snake {
+    RingBody body;
+    OccupancyGrid occupancy;
+    ivec2 direction = {1, 0};
+    bool add_segment = false;
+
+    // Room for a snake on every cell, plus the head that runs into it
+    explicit Snake(ivec2 grid_size)
+        : body(static_cast<size_t>(grid_size.x) * static_cast<size_t>(grid_size.y) + 1), occupancy(grid_size) {
+        reset();
+    }
+
+    // Three cells heading right, at (4..6, 9) on grids big enough for it
+    void reset() {
+        ivec2 const tail{std::min(4, occupancy.size.x - 3), std::min(9, occupancy.size.y - 1)};
+        std::array const start = {tail + ivec2{2, 0}, tail + ivec2{1, 0}, tail};
+        setBody(start);
+        direction = {1, 0};
+        add_segment = false;
+    }
+
+    // Head first
+    void setBody(std::span<ivec2 const> cells) {
+        body.clear();
+        occupancy.clear();
+        for (auto it = cells.rbegin(); it != cells.rend(); ++it) {
+            pushFront(*it);
+        }
+    }
+
+    void pushFront(ivec2 cell) {
+        body.push_front(cell);
+        occupancy.add(cell);
+    }
+
+    void popBack() {
+        occupancy.remove(body.back());
+        body.pop_back();
+    }
+
+    void update() {
+        pushFront(body[0] + direction);
+        if (add_segment) {
+            add_segment = false;
+        } else {
+            popBack();
+        }
+    }
+
+    [[nodiscard]] auto occupies(ivec2 cell) const -> bool { return occupancy.occupied(cell); }
+
+    // The head's own segment counts once, any other on its cell is the body
+    [[nodiscard]] auto headHitsTail() const -> bool { return occupancy.count(body[0]) > 1; }
+};
+
+// What a tick did, for the frontend to play sounds
+enum class Event : uint8_t { None, Moved, Ate, Died, Won };
+
+// One game: the snake, the food and the score, with its own random generator so games are reproducible from a seed
+struct Logic {
+    Snake snake;
+    ivec2 food{};
+    rng::Pcg32 rng;
+    bool running = true;
+    bool won = false;
+    int score = 0;
+
+    Logic(ivec2 grid_size, uint64_t seed) : snake(grid_size), rng(seed) { food = randomFreeCell().value_or(ivec2{}); }
+
+    [[nodiscard]] auto size() const -> ivec2 { return snake.occupancy.size; }
+
+    // A uniformly random empty cell, none when the snake fills the grid
+    auto randomFreeCell() -> std::optional<ivec2> {
+        size_t const num_free = snake.occupancy.num_free;
+        if (num_free == 0) {
+            return {};
+        }
+        return snake.occupancy.freeCell(rng.bounded(static_cast<uint32_t>(num_free)));
+    }
+
+    // Starts over with a long snake winding over the top rows, see windingBody, leaving at least one cell for the food
+    void setWinding(size_t length) {
+        size_t const num_cells = snake.occupancy.numCells();
+        std::vector<ivec2> const body = windingBody(size(), std::clamp<size_t>(length, 2, num_cells - 1));
+        snake.setBody(body);
+        snake.direction = body[0] - body[1];
+        snake.add_segment = false;
+        food = randomFreeCell().value_or(ivec2{});
+    }
+
+    // Turning back onto the body is ignored. Starts the next game after a game over.
+    void steer(ivec2 direction) {
+        if (direction == -snake.direction) {
+            return;
+        }
+        snake.direction = direction;
+        running = true;
+    }
+
+    auto step() -> Event {
+        if (!running) {
+            return Event::None;
+        }
+        if (won) {
+            won = false;
+            score = 0;
+        }
+        snake.update();
+        ivec2 const head = snake.body.front();
+        if (head == food) {
+            snake.add_segment = true;
+            score++;
+            std::optional<ivec2> next_food = randomFreeCell();
+            if (!next_food.has_value()) {
+                win();
+                return Event::Won;
+            }
+            food = next_food.value();
+            return Event::Ate;
+        }
+        if (!snake.occupancy.inside(head) || snake.headHitsTail()) {
+            gameOver();
+            return Event::Died;
+        }
+        return Event::Moved;
+    }
+
+    // The snake fills the grid. The final score stays until the next game starts.
+    void win() {
+        snake.reset();
+        food = randomFreeCell().value_or(ivec2{});
+        running = false;
+        won = true;
+    }
+
+    void gameOver() {
+        snake.reset();
+        food = randomFreeCell().value_or(ivec2{});
+        running = false;
+        score = 0;
+    }
+};
+
+} // namespace snake
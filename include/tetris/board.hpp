@@ -1,162 +1,317 @@
 #pragma once
 
+#include "input.hpp"
 #include "piece.hpp"
-#include "raylib.h"
+#include "randomizer.hpp"
 #include "score.hpp"
 #include "tetris.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <glm/ext/vector_int2.hpp>
-#include <iostream>
 #include <optional>
-#include <random>
-#include <set>
+#include <utility>
 
 namespace tetris {
 
-struct Board {
+struct Rotation {
+    ivec2 position;
+    Orientation orientation;
+    bool kicked;
+};
+
+constexpr size_t bags_per_refill = 8;
+
+// Bitboard-only counterparts of the lock path, for search code that does not need the colour plane
+template <typename R = StandardRules>
+inline void placePiece(typename R::Rows& rows, Tetromino type, ivec2 pos, Orientation orientation) {
+    using Row = typename R::Row;
+    PieceMask const& mask = R::masks[type][orientation];
+    for (int dy = mask.min_y; dy <= mask.max_y; dy++) {
+        rows[pos.y + dy] |= static_cast<Row>(Row{mask.rows[dy]} << (pos.x + wall_width));
+    }
+}
+
+// Removes full rows in a single bottom-up pass and returns how many were removed
+template <typename R = StandardRules> inline auto clearFullRows(typename R::Rows& rows) -> size_t {
+    int write = R::num_rows - 1;
+    for (int read = R::num_rows - 1; read >= 0; read--) {
+        if (rows[read] != R::full_row) {
+            rows[write--] = rows[read];
+        }
+    }
+    auto const cleared = static_cast<size_t>(write + 1);
+    for (; write >= 0; write--) {
+        rows[write] = R::empty_row;
+    }
+    return cleared;
+}
+
+// True when no cell of the playfield is filled
+template <typename R = StandardRules> inline auto fieldEmpty(typename R::Rows const& rows) -> bool {
+    return std::all_of(rows.begin(), rows.begin() + R::num_rows,
+                       [](typename R::Row row) { return row == R::empty_row; });
+}
+
+template <typename R = StandardRules> struct BasicSurface {
+    std::array<int, R::num_cols> heights;
+    int holes;
+};
+using Surface = BasicSurface<>;
+
+// Column heights and the number of empty cells under them, in one top-down pass over the bitboard
+template <typename R = StandardRules> inline auto surfaceFeatures(typename R::Rows const& rows) -> BasicSurface<R> {
+    using Row = typename R::Row;
+    constexpr Row field = static_cast<Row>(~R::empty_row);
+    BasicSurface<R> surface{};
+    Row covered = 0;
+    for (int r = 0; r < R::num_rows; r++) {
+        Row const row = rows[r] & field;
+        surface.holes += std::popcount(static_cast<Row>(~row & covered & field));
+        for (Row fresh = row & ~covered; fresh != 0; fresh &= fresh - 1) {
+            surface.heights[std::countr_zero(fresh) - wall_width] = R::num_rows - r;
+        }
+        covered |= row;
+    }
+    return surface;
+}
+
+// A board under the compile-time rules R, see Rules. The geometry names below shadow the standard ones of tetris.hpp.
+template <typename R> struct BasicBoard {
+    using Row = typename R::Row;
+    using Rows = typename R::Rows;
+    static constexpr int num_cols = R::num_cols;
+    static constexpr int num_rows = R::num_rows;
+    static constexpr Row full_row = R::full_row;
+    static constexpr Row empty_row = R::empty_row;
+    static constexpr uint32_t all_rows_dirty = (1U << num_rows) - 1;
+
+    // Colour plane, only consulted for drawing. Collisions go through the occupancy bitboard in `rows`.
     std::array<std::array<std::optional<Tetromino>, num_cols>, num_rows> state{};
-    Piece active_piece{Tetromino{}};
-    Piece ghost_piece{Tetromino{}};
+    Rows rows{};
+    // Surface index: number of rows from the floor up to and including the highest filled cell of each column. Kept
+    // up to date by setCell and clearLines.
+    std::array<int, num_cols> column_heights{};
+    // One bit per row whose locked cells changed since the renderer last called takeDirtyRows
+    uint32_t dirty_rows = all_rows_dirty;
+    Piece active_piece{Tetromino{}, R::spawn_positions[Tetromino{}]};
+    Piece ghost_piece{Tetromino{}, R::spawn_positions[Tetromino{}]};
     std::optional<Tetromino> hold_piece;
     bool just_swapped_hold = false;
 
-    double last_update_time = GetTime();
+    // Timestamp of the step being simulated, supplied by the caller of update()
+    double current_time = 0;
+    double last_update_time = 0;
+    // Rows of gravity built up since the piece last moved down, only the whole part is applied
+    double gravity_rows = 0;
     bool lock_delay = false;
     double lock_delay_start_time = 0;
     bool running = true;
 
     int level = 0;
     size_t current_level_lines_cleared = 0;
+    size_t total_lines_cleared = 0;
+    size_t pieces_locked = 0;
     double tick_rate = level_tick_rates[level];
 
-    SlideState slide_state{SlideState::Inactive};
-    double slide_timer = 0;
-
-    // 7 bag randomization
-    std::random_device rd;
-    std::mt19937 g{rd()};
-    std::array<Tetromino, Tetromino::NUM_TETROMINOS> random_bag_0 = {I, J, L, O, S, T, Z};
-    std::array<Tetromino, Tetromino::NUM_TETROMINOS> random_bag_1 = {I, J, L, O, S, T, Z};
+    // Keys held as of the last input event
+    bool left_held = false;
+    bool right_held = false;
+    bool soft_drop_held = false;
+    // Auto-shift direction (-1, 0 or 1) and when the next repeat is due. The first repeat comes slide_delay_period +
+    // slide_rate after the press, then one every slide_rate, at exact times however the steps fall.
+    int slide_direction = 0;
+    double next_slide_time = 0;
+    // Snapshot from the previous update(now, InputState), diffed into events
+    InputState last_input{};
+
+    // 7 bag randomization, generated `bags_per_refill` bags at a time
+    BagRandomizer randomizer;
+    std::array<Tetromino, bags_per_refill * NUM_TETROMINOS> bag_buffer{};
+    size_t bag_index = 0;
     std::array<Tetromino, num_next_pieces + 1> curr_and_next_pieces{};
-    std::array<Tetromino, Tetromino::NUM_TETROMINOS>::iterator bag_pointer;
-    bool bag_0 = true;
 
     ScoreState score_state{};
+    ScoreEventQueue score_events{};
     TSpinType last_move{};
 
-    Board() { reset(); }
+    explicit BasicBoard(uint32_t seed, RandomizerKind randomizer_kind = RandomizerKind::Pcg32)
+        : randomizer(seed, randomizer_kind) {
+        reset();
+    }
 
     void reset();
+    void spawnPiece(Tetromino type);
+    void setCell(int row, int col, Tetromino type);
+    auto takeDirtyRows() -> uint32_t;
+    auto takeFromBag() -> Tetromino;
     auto getNextTetromino() -> Tetromino;
-    auto tick(double interval) -> bool;
     [[nodiscard]] auto collisionCheck(Tetromino type, ivec2 pos_bound, Orientation orientation) const -> bool;
+    [[nodiscard]] auto dropDistance(Tetromino type, ivec2 pos, Orientation orientation) const -> int;
+    [[nodiscard]] auto holes() const -> int;
+    [[nodiscard]] auto rotationTest(Tetromino type, ivec2 position, Orientation const& current_orientation,
+                                    bool clockwise) const -> std::optional<Rotation>;
     void handleRotationTests(Orientation const& current_orientation, bool clockwise);
-    void updateRotation();
-    void updateHorizontalTranslation();
-    void updateVerticalTranslation();
-    void clearLine(int line);
-    auto clearLines(std::set<int>& lines) -> size_t;
+    void rotate(bool clockwise);
+    void hardDrop();
+    void updateTickRate();
+    void updateSlideDirection();
+    void releaseKeys();
+    void applyInput(InputEvent const& event);
+    auto clearLines(int top, int bottom) -> size_t;
     void translate(ivec2 translation);
     void triggerLock(TSpinType t_spin_type);
     void updateSpawn();
     void updateFall();
-    void updateSlideState(ivec2 translation);
-    void update();
+    void stepTo(double time);
+    void advanceTo(double time);
+    void update(double now, InputEventQueue& events);
+    void update(double now, InputState const& input);
     void updateGhostPiece();
-    void updateHoldPiece();
-    void drawCell(int row, int col) const;
-    static void drawGrid();
-    void draw() const;
+    void holdPiece();
+    void addGarbage(int lines, int hole_column);
 };
 
-inline void Board::reset() {
+using Board = BasicBoard<StandardRules>;
+
+template <typename R> inline void BasicBoard<R>::reset() {
     state = {};
-    std::shuffle(random_bag_0.begin(), random_bag_0.end(), g);
-    std::shuffle(random_bag_1.begin(), random_bag_1.end(), g);
-    bag_pointer = random_bag_0.begin();
-    active_piece.type = *bag_pointer;
-    for (size_t i = 0; i < num_next_pieces; i++) {
-        curr_and_next_pieces[i] = *bag_pointer++;
+    column_heights = {};
+    dirty_rows = all_rows_dirty;
+    std::fill(rows.begin(), rows.begin() + num_rows, empty_row);
+    std::fill(rows.begin() + num_rows, rows.end(), full_row);
+    bag_index = bag_buffer.size();
+    for (auto& piece : curr_and_next_pieces) {
+        piece = takeFromBag();
+    }
+    active_piece.type = curr_and_next_pieces[0];
+}
+
+template <typename R> inline void BasicBoard<R>::spawnPiece(Tetromino type) {
+    active_piece.reset(type, R::spawn_positions[type]);
+}
+
+template <typename R> inline void BasicBoard<R>::setCell(int row, int col, Tetromino type) {
+    state[row][col] = type;
+    rows[row] |= R::cellBit(col);
+    column_heights[col] = std::max(column_heights[col], num_rows - row);
+    dirty_rows |= 1U << row;
+}
+
+template <typename R> inline auto BasicBoard<R>::takeDirtyRows() -> uint32_t { return std::exchange(dirty_rows, 0); }
+
+template <typename R> inline auto BasicBoard<R>::takeFromBag() -> Tetromino {
+    if (bag_index == bag_buffer.size()) {
+        randomizer.generate(bag_buffer);
+        bag_index = 0;
     }
-    curr_and_next_pieces[num_next_pieces] = *bag_pointer;
-    bag_pointer = random_bag_1.begin();
-    bag_0 = false;
+    return bag_buffer[bag_index++];
 }
 
-inline auto Board::getNextTetromino() -> Tetromino {
+template <typename R> inline auto BasicBoard<R>::getNextTetromino() -> Tetromino {
     for (size_t i = 0; i < num_next_pieces; i++) {
         curr_and_next_pieces[i] = curr_and_next_pieces[i + 1];
     }
-    curr_and_next_pieces[num_next_pieces] = *bag_pointer++;
-    if (bag_0 && bag_pointer == random_bag_0.end()) {
-        std::shuffle(random_bag_1.begin(), random_bag_1.end(), g);
-        bag_pointer = random_bag_1.begin();
-        bag_0 = false;
-    } else if (!bag_0 && bag_pointer == random_bag_1.end()) {
-        std::shuffle(random_bag_0.begin(), random_bag_0.end(), g);
-        bag_pointer = random_bag_0.begin();
-        bag_0 = true;
-    }
+    curr_and_next_pieces[num_next_pieces] = takeFromBag();
     return curr_and_next_pieces[0];
 }
 
-inline auto Board::tick(double interval) -> bool {
-    double current_time = GetTime();
-    if (current_time - last_update_time >= interval) {
-        last_update_time = current_time;
+template <typename R>
+inline auto BasicBoard<R>::collisionCheck(Tetromino type, ivec2 pos_bound, Orientation orientation) const -> bool {
+    PieceMask const& mask = R::masks[type][orientation];
+    if (pos_bound.x + mask.min_x < -wall_width || pos_bound.x + mask.max_x >= num_cols + wall_width ||
+        pos_bound.y + mask.min_y < 0 || pos_bound.y + mask.max_y >= num_rows) {
         return true;
     }
-    return false;
-}
-
-inline auto Board::collisionCheck(Tetromino type, ivec2 pos_bound, Orientation orientation) const -> bool {
-    auto const& piece_rel_pos = piece_attributes[type].states[orientation];
-    return std::any_of(piece_rel_pos.begin(), piece_rel_pos.end(), [pos_bound, this](ivec2 const& rel_pos) {
-        ivec2 absolute_pos = rel_pos + pos_bound;
-        bool within_bounds =
-            0 <= absolute_pos.x && absolute_pos.x < num_cols && absolute_pos.y < num_rows && 0 <= absolute_pos.y;
-        return !within_bounds || state[absolute_pos.y][absolute_pos.x].has_value();
-    });
+    int const shift = pos_bound.x + wall_width;
+    // A mask with empty leading rows or columns can sit at y < 0 or x < -wall_width with all of its cells inside. Only
+    // its occupied rows are read then, and columns left of the wall are shifted out of the mask, which has none there.
+    if (pos_bound.y < 0 || shift < 0) [[unlikely]] {
+        Row hits = 0;
+        for (int i = mask.min_y; i <= mask.max_y; i++) {
+            Row const row_mask = shift >= 0 ? static_cast<Row>(Row{mask.rows[i]} << shift)
+                                            : static_cast<Row>(Row{mask.rows[i]} >> -shift);
+            hits |= rows[pos_bound.y + i] & row_mask;
+        }
+        return hits != 0;
+    }
+    // The floor rows below the playfield keep all four row reads in bounds, so no per-row branching is needed
+    auto const* board_rows = &rows[pos_bound.y];
+    return ((board_rows[0] & static_cast<Row>(Row{mask.rows[0]} << shift)) |
+            (board_rows[1] & static_cast<Row>(Row{mask.rows[1]} << shift)) |
+            (board_rows[2] & static_cast<Row>(Row{mask.rows[2]} << shift)) |
+            (board_rows[3] & static_cast<Row>(Row{mask.rows[3]} << shift))) != 0;
 }
 
-inline void Board::handleRotationTests(Orientation const& current_orientation, bool clockwise) {
-    WallTests const& wall_tests = active_piece.type == I ? wall_kick_tests_i : wall_kick_tests_not_i;
+template <typename R>
+inline auto BasicBoard<R>::rotationTest(Tetromino type, ivec2 position, Orientation const& current_orientation,
+                                        bool clockwise) const -> std::optional<Rotation> {
+    auto const& wall_tests = R::Rotations::kicks(type);
     Orientation new_orientation = clockwise ? current_orientation++ : current_orientation--;
     bool first_test = true;
     for (ivec2 const& wall_test : wall_tests[current_orientation][static_cast<size_t>(clockwise)]) {
-        ivec2 new_position{active_piece.position.x + wall_test.x, active_piece.position.y - wall_test.y};
-        if (!collisionCheck(active_piece.type, new_position, new_orientation)) {
-            lock_delay = false;
-            active_piece.orientation = new_orientation;
-            active_piece.position = new_position;
-            if (active_piece.type == T) {
-                if (first_test) {
-                    last_move = TSpinType::NoWallKick;
-                } else {
-                    last_move = TSpinType::WallKick;
-                }
-            }
-            return;
+        ivec2 new_position{position.x + wall_test.x, position.y - wall_test.y};
+        if (!collisionCheck(type, new_position, new_orientation)) {
+            return Rotation{.position = new_position, .orientation = new_orientation, .kicked = !first_test};
         }
         first_test = false;
     }
+    return {};
 }
 
-inline void Board::updateRotation() {
-    if (active_piece.type == Tetromino::O) {
+// Rows the piece can fall before landing. When every cell is above its column's surface this is a lookup against
+// column_heights, otherwise (the piece is tucked under an overhang) it falls back to stepping down.
+template <typename R>
+inline auto BasicBoard<R>::dropDistance(Tetromino type, ivec2 pos, Orientation orientation) const -> int {
+    if (collisionCheck(type, pos, orientation)) {
+        return 0;
+    }
+    PieceMask const& mask = R::masks[type][orientation];
+    int distance = num_rows;
+    for (int dx = mask.min_x; dx <= mask.max_x; dx++) {
+        int const bottom = pos.y + mask.column_bottoms[dx];
+        int const surface_row = num_rows - column_heights[pos.x + dx];
+        if (bottom >= surface_row) {
+            distance = 0;
+            while (!collisionCheck(type, pos + ivec2{0, distance + 1}, orientation)) {
+                distance++;
+            }
+            return distance;
+        }
+        distance = std::min(distance, surface_row - 1 - bottom);
+    }
+    return distance;
+}
+
+template <typename R> inline auto BasicBoard<R>::holes() const -> int { return surfaceFeatures<R>(rows).holes; }
+
+template <typename R>
+inline void BasicBoard<R>::handleRotationTests(Orientation const& current_orientation, bool clockwise) {
+    std::optional<Rotation> rotation =
+        rotationTest(active_piece.type, active_piece.position, current_orientation, clockwise);
+    if (!rotation.has_value()) {
         return;
     }
-    if (IsKeyPressed(KEY_Z)) {
-        handleRotationTests(active_piece.orientation, false);
-    } else if (IsKeyPressed(KEY_X)) {
-        handleRotationTests(active_piece.orientation, true);
+    lock_delay = false;
+    active_piece.orientation = rotation->orientation;
+    active_piece.position = rotation->position;
+    if (active_piece.type == T) {
+        last_move = rotation->kicked ? TSpinType::WallKick : TSpinType::NoWallKick;
+    }
+}
+
+template <typename R> inline void BasicBoard<R>::rotate(bool clockwise) {
+    if (active_piece.type != Tetromino::O) {
+        handleRotationTests(active_piece.orientation, clockwise);
     }
 }
 
-inline void Board::translate(ivec2 translation) {
+template <typename R> inline void BasicBoard<R>::translate(ivec2 translation) {
     ivec2 new_position = active_piece.position + translation;
     if (!collisionCheck(active_piece.type, new_position, active_piece.orientation)) {
         lock_delay = false;
@@ -165,71 +320,109 @@ inline void Board::translate(ivec2 translation) {
     }
 }
 
-inline void Board::updateSlideState(ivec2 translation) {
-    if (slide_state == SlideState::Inactive) {
-        slide_state = SlideState::StartDelay;
-        slide_timer = GetTime();
-        translate(translation);
-    } else if (slide_state == SlideState::StartDelay && GetTime() - slide_timer > slide_delay_period) {
-        slide_state = SlideState::Slide;
-        slide_timer = GetTime();
-    } else if (slide_state == SlideState::Slide && GetTime() - slide_timer > slide_rate) {
-        slide_timer = GetTime();
-        translate(translation);
+// Holding both directions, or neither, stops the auto-shift. A new direction shifts once right away.
+template <typename R> inline void BasicBoard<R>::updateSlideDirection() {
+    int const direction = left_held == right_held ? 0 : (left_held ? -1 : 1);
+    if (direction == slide_direction) {
+        return;
+    }
+    slide_direction = direction;
+    if (direction != 0) {
+        translate(ivec2{direction, 0});
+        next_slide_time = current_time + slide_delay_period + slide_rate;
     }
 }
 
-inline void Board::updateHorizontalTranslation() {
-    if (IsKeyDown(KEY_LEFT) && !IsKeyDown(KEY_RIGHT)) {
-        updateSlideState(ivec2{-1, 0});
-    } else if (IsKeyDown(KEY_RIGHT) && !IsKeyDown(KEY_LEFT)) {
-        updateSlideState(ivec2{1, 0});
-    } else {
-        slide_state = SlideState::Inactive;
-    }
+// As if every held key was released now
+template <typename R> inline void BasicBoard<R>::releaseKeys() {
+    left_held = false;
+    right_held = false;
+    soft_drop_held = false;
+    updateSlideDirection();
+    updateTickRate();
 }
 
-inline void Board::updateVerticalTranslation() {
-    if (IsKeyPressed(KEY_SPACE)) {
-        if (active_piece.position == ghost_piece.position) {
-            triggerLock(last_move);
-            return;
-        }
-        active_piece.position = ghost_piece.position;
-        triggerLock(TSpinType::NotTSpin);
+template <typename R> inline void BasicBoard<R>::hardDrop() {
+    // The active piece may have changed since the last step (hold), so the ghost must be current
+    updateGhostPiece();
+    if (active_piece.position == ghost_piece.position) {
+        triggerLock(last_move);
         return;
     }
-    if (IsKeyDown(KEY_DOWN)) {
-        tick_rate = level_down_tick_rates[level];
-    } else {
-        tick_rate = level_tick_rates[level];
-    }
+    active_piece.position = ghost_piece.position;
+    triggerLock(TSpinType::NotTSpin);
 }
 
-inline void Board::clearLine(int line) {
-    assert(0 <= line && line < num_rows);
-    for (int line_write = line; line_write > 0; line_write--) {
-        state[line_write] = state[line_write - 1];
-    }
+template <typename R> inline void BasicBoard<R>::updateTickRate() {
+    tick_rate = soft_drop_held ? level_down_tick_rates[level] : level_tick_rates[level];
 }
 
-inline auto Board::clearLines(std::set<int>& lines) -> size_t {
-    for (auto line = lines.begin(); line != lines.end();) {
-        if (std::any_of(state[*line].begin(), state[*line].end(), [](auto&& c) { return !c.has_value(); })) {
-            lines.erase(line++);
-        } else {
-            line++;
+template <typename R> inline void BasicBoard<R>::applyInput(InputEvent const& event) {
+    TRACE_SCOPE("Board::applyInput");
+    switch (event.key) {
+    case Key::Left:
+        left_held = event.pressed;
+        updateSlideDirection();
+        break;
+    case Key::Right:
+        right_held = event.pressed;
+        updateSlideDirection();
+        break;
+    case Key::SoftDrop:
+        soft_drop_held = event.pressed;
+        updateTickRate();
+        break;
+    case Key::RotateClockwise:
+    case Key::RotateAnticlockwise:
+        if (event.pressed) {
+            rotate(event.key == Key::RotateClockwise);
+        }
+        break;
+    case Key::HardDrop:
+        if (event.pressed) {
+            hardDrop();
+        }
+        break;
+    case Key::Hold:
+        if (event.pressed) {
+            holdPiece();
         }
+        break;
+    case Key::NumKeys:
+        break;
     }
+}
 
-    // This _can_ be optimized, but it doesn't _need_ to be.
-    for (auto line : lines) {
-        clearLine(line);
+// Removes the full rows among [top, bottom], the rows touched by the last lock, in one bottom-up pass that moves each
+// surviving row straight to its final position
+template <typename R> inline auto BasicBoard<R>::clearLines(int top, int bottom) -> size_t {
+    assert(0 <= top && top <= bottom && bottom < num_rows);
+    if (std::none_of(rows.begin() + top, rows.begin() + bottom + 1, [](Row row) { return row == full_row; })) {
+        return 0;
+    }
+    int write = bottom;
+    for (int read = bottom; read >= 0; read--) {
+        if (read >= top && rows[read] == full_row) {
+            continue;
+        }
+        if (write != read) {
+            rows[write] = rows[read];
+            state[write] = state[read];
+        }
+        write--;
     }
-    return lines.size();
+    auto const lines_cleared = static_cast<size_t>(write + 1);
+    for (; write >= 0; write--) {
+        rows[write] = empty_row;
+        state[write] = {};
+    }
+    column_heights = surfaceFeatures<R>(rows).heights;
+    // Rows above the lowest cleared one have all moved down
+    dirty_rows |= (2U << bottom) - 1;
+    return lines_cleared;
 }
 
-inline void Board::updateSpawn() {
+template <typename R> inline void BasicBoard<R>::updateSpawn() {
     if (!collisionCheck(active_piece.type, active_piece.position, active_piece.orientation)) {
         return;
     }
@@ -241,31 +434,34 @@ inline void Board::updateSpawn() {
         active_piece.position -= ivec2{0, 2};
         return;
     }
-    std::cout << "Game Over" << std::endl;
     running = false;
 }
 
-inline void Board::triggerLock(TSpinType t_spin_type) {
+template <typename R> inline void BasicBoard<R>::triggerLock(TSpinType t_spin_type) {
+    TRACE_SCOPE("Board::triggerLock");
     lock_delay = false;
-    auto const& piece_rel_pos = piece_attributes[active_piece.type].states[active_piece.orientation];
-    std::set<int> clear_lines{};
+    auto const& piece_rel_pos = R::states[active_piece.type][active_piece.orientation];
     for (auto const& pos_rel : piece_rel_pos) {
         ivec2 absolute_pos = active_piece.position + pos_rel;
-        state[absolute_pos.y][absolute_pos.x] = active_piece.type;
-        clear_lines.insert(absolute_pos.y);
+        setCell(absolute_pos.y, absolute_pos.x, active_piece.type);
     }
 
-    if (std::all_of(clear_lines.begin(), clear_lines.end(), [](int line) -> bool { return line < 2; })) {
-        std::cout << "Game Over" << std::endl;
+    PieceMask const& mask = R::masks[active_piece.type][active_piece.orientation];
+    int const top = active_piece.position.y + mask.min_y;
+    int const bottom = active_piece.position.y + mask.max_y;
+    if (bottom < 2) {
         running = false;
     }
 
-    size_t lines_cleared = clearLines(clear_lines);
+    size_t lines_cleared = clearLines(top, bottom);
+    pieces_locked++;
     if (lines_cleared > 0) {
+        total_lines_cleared += lines_cleared;
         current_level_lines_cleared += lines_cleared;
         if (level + 1 < num_levels && current_level_lines_cleared >= 10) {
             level++;
             current_level_lines_cleared = 0;
+            updateTickRate();
         }
     } else {
         score_state.resetCombo();
@@ -273,117 +469,149 @@ inline void Board::triggerLock(TSpinType t_spin_type) {
 
     std::optional<BaseActionScore> base_action_score = toBaseActionScore(lines_cleared, t_spin_type);
     if (base_action_score.has_value()) {
-        score_state.score(base_action_score.value(), level, 0, 0);
+        bool const perfect_clear = lines_cleared > 0 && fieldEmpty<R>(rows);
+        score_events.push(score_state.score(base_action_score.value(), level, 0, 0, perfect_clear));
     }
 
-    active_piece.reset(getNextTetromino());
+    spawnPiece(getNextTetromino());
     just_swapped_hold = false;
-    last_update_time = GetTime();
+    gravity_rows = 0;
     updateSpawn();
 }
 
-inline void Board::updateFall() {
-    ivec2 new_position = active_piece.position + ivec2{0, 1};
-    if (!collisionCheck(active_piece.type, new_position, active_piece.orientation)) {
-        lock_delay = false;
-        active_piece.position = new_position;
-        last_move = TSpinType::NotTSpin;
-    } else if (!lock_delay) {
+// Applies every whole row of accumulated gravity in one move, capped by the drop distance, so the fall speed does not
+// depend on the frame rate. At 20G the piece goes straight down to the stack. Once it rests there the lock delay is
+// checked on every step.
+template <typename R> inline void BasicBoard<R>::updateFall() {
+    double const whole_rows = std::floor(gravity_rows);
+    gravity_rows -= whole_rows;
+    bool const twenty_g = tick_rate <= twenty_g_tick_rate;
+    if (twenty_g || whole_rows >= 1) {
+        int const distance = dropDistance(active_piece.type, active_piece.position, active_piece.orientation);
+        int const rows = twenty_g || whole_rows >= distance ? distance : static_cast<int>(whole_rows);
+        if (rows > 0) {
+            lock_delay = false;
+            active_piece.position.y += rows;
+            last_move = TSpinType::NotTSpin;
+        }
+        if (rows < distance) {
+            return;
+        }
+    } else if (!collisionCheck(active_piece.type, active_piece.position + ivec2{0, 1}, active_piece.orientation)) {
+        return;
+    }
+    if (!lock_delay) {
         lock_delay = true;
-        lock_delay_start_time = GetTime();
-    } else if (GetTime() - lock_delay_start_time >= lock_delay_period) {
+        lock_delay_start_time = current_time;
+    } else if (current_time - lock_delay_start_time >= lock_delay_period) {
         lock_delay = false;
         triggerLock(last_move);
     }
 }
 
-inline void Board::drawCell(int row, int col) const {
-    if (state[row][col].has_value()) {
-        auto type = state[row][col].value();
-        Rectangle r{.x = static_cast<float>(hold_width + offset + static_cast<float>(col) * cell_size),
-                    .y = static_cast<float>(offset + static_cast<float>(row - 2) * cell_size),
-                    .width = cell_size,
-                    .height = cell_size};
-        DrawRectangleRounded(r, 0.4, 6, piece_attributes[type].color);
-    }
-}
-
-inline void Board::updateHoldPiece() {
-    if (IsKeyPressed(KEY_LEFT_SHIFT) && !just_swapped_hold) {
+template <typename R> inline void BasicBoard<R>::holdPiece() {
+    if (!just_swapped_hold) {
         just_swapped_hold = true;
         Tetromino temp = active_piece.type;
         if (hold_piece.has_value()) {
-            active_piece.reset(hold_piece.value());
+            spawnPiece(hold_piece.value());
         } else {
-            active_piece.reset(getNextTetromino());
+            spawnPiece(getNextTetromino());
         }
         updateSpawn();
         hold_piece = temp;
     }
 }
 
-inline void Board::updateGhostPiece() {
-    ivec2 target_position = active_piece.position;
-    while (!collisionCheck(active_piece.type, target_position + ivec2{0, 1}, active_piece.orientation)) {
-        target_position.y++;
-    }
-    ghost_piece.position = target_position;
+template <typename R> inline void BasicBoard<R>::updateGhostPiece() {
+    TRACE_SCOPE("Board::updateGhostPiece");
+    int const distance = dropDistance(active_piece.type, active_piece.position, active_piece.orientation);
+    ghost_piece.position = active_piece.position + ivec2{0, distance};
     ghost_piece.orientation = active_piece.orientation;
     ghost_piece.type = active_piece.type;
 }
 
-inline void Board::update() {
-    if (!running) {
-        return;
-    }
-    updateHoldPiece();
-    updateRotation();
-    updateVerticalTranslation();
-    updateHorizontalTranslation();
-    if (tick(tick_rate)) {
-        updateFall();
-    }
-    updateGhostPiece();
+// Simulates gravity and the lock delay up to `time`
+template <typename R> inline void BasicBoard<R>::stepTo(double time) {
+    current_time = time;
+    // At the rate that was in effect since the previous step
+    gravity_rows += (time - last_update_time) / tick_rate;
+    last_update_time = time;
+    updateFall();
 }
 
-inline void Board::drawGrid() {
-    for (int row = 0; row < num_rows - 1; row++) {
-        DrawLine(hold_width + offset, row * cell_size + (int)offset, hold_width + offset + num_cols * cell_size,
-                 row * cell_size + (int)offset, DARKGRAY);
+// Simulates up to `time`, stopping at every auto-shift due on the way
+template <typename R> inline void BasicBoard<R>::advanceTo(double time) {
+    TRACE_SCOPE("Board::advanceTo");
+    while (running && slide_direction != 0 && next_slide_time <= time) {
+        stepTo(next_slide_time);
+        if (running) {
+            translate(ivec2{slide_direction, 0});
+        }
+        next_slide_time += slide_rate;
     }
-    for (int col = 0; col <= num_cols; col++) {
-        DrawLine((int)hold_width + (int)offset + col * cell_size, offset,
-                 (int)hold_width + (int)offset + col * cell_size, offset + (num_rows - 2) * cell_size, DARKGRAY);
+    if (running) {
+        stepTo(time);
     }
 }
 
-inline void Board::draw() const {
-    for (int row = 2; row < num_rows; row++) {
-        for (int col = 0; col < num_cols; col++) {
-            drawCell(row, col);
+// Runs the simulation up to `now`, handling each queued event with time <= now at that time. Later events stay queued.
+template <typename R> inline void BasicBoard<R>::update(double now, InputEventQueue& events) {
+    TRACE_SCOPE("Board::update");
+    while (running && !events.empty() && events.front().time <= now) {
+        InputEvent const event = events.pop().value();
+        if (event.time > current_time) {
+            advanceTo(event.time);
+        }
+        if (running) {
+            applyInput(event);
         }
     }
-    drawGrid();
-    if (hold_piece.has_value()) {
-        Piece::drawTetromino(hold_piece.value(), hold_position, medium_piece_size);
+    if (running) {
+        advanceTo(now);
+    } else {
+        events.clear();
     }
+    updateGhostPiece();
+}
 
-    Piece::drawTetromino(curr_and_next_pieces[1], first_next_position, medium_piece_size);
-    for (int i = 1; i < num_next_pieces; i++) {
-        Piece::drawTetromino(curr_and_next_pieces[i + 1], next_position + i * ivec2{0, next_position_spacing},
-                             tiny_piece_size);
-    }
+// Frame-polled input: the snapshot is diffed against the previous one and handled as events at `now`
+template <typename R> inline void BasicBoard<R>::update(double now, InputState const& input) {
+    InputEventQueue events;
+    pushInputChanges(last_input, input, now, events);
+    last_input = input;
+    update(now, events);
+}
 
-    if (!running) {
+// Pushes the stack up by `lines` and fills the bottom with garbage rows open at `hole_column`. Tops out if locked cells
+// are pushed off the top, or if the active piece cannot be moved up out of the way.
+template <typename R> inline void BasicBoard<R>::addGarbage(int lines, int hole_column) {
+    lines = std::min(lines, num_rows);
+    if (lines <= 0) {
         return;
     }
-    active_piece.draw();
-    ghost_piece.drawGhost();
-
-    DrawText(TextFormat("Hold"), 45, 35, 20, WHITE);
-    DrawText(TextFormat("Next"), 485, 35, 20, WHITE);
-    DrawText(TextFormat("Level: %i", level + 1), 30, 500, 20, WHITE);
-    DrawText(TextFormat("Score: %i", score_state.current_score), 20, 550, 20, WHITE);
+    if (std::any_of(rows.begin(), rows.begin() + lines, [](Row row) { return row != empty_row; })) {
+        running = false;
+    }
+    std::copy(rows.begin() + lines, rows.begin() + num_rows, rows.begin());
+    std::copy(state.begin() + lines, state.end(), state.begin());
+    auto const garbage_row = static_cast<Row>(full_row & ~R::cellBit(hole_column));
+    for (int r = num_rows - lines; r < num_rows; r++) {
+        rows[r] = garbage_row;
+        state[r].fill(garbage_cell);
+        state[r][hole_column].reset();
+    }
+    column_heights = surfaceFeatures<R>(rows).heights;
+    dirty_rows = all_rows_dirty;
+
+    int const piece_top = R::masks[active_piece.type][active_piece.orientation].min_y;
+    while (running && collisionCheck(active_piece.type, active_piece.position, active_piece.orientation)) {
+        if (active_piece.position.y + piece_top <= 0) {
+            running = false;
+        }
+        active_piece.position.y--;
+    }
+    updateGhostPiece();
 }
 
 } // namespace tetris
\ No newline at end of file
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "board.hpp"
+#include "movegen.hpp"
+#include "score.hpp"
+#include "tetris.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace tetris {
+
+struct BotWeights {
+    double height = -0.3;
+    double danger_height = -2.0;
+    double holes = -4.0;
+    double bumpiness = -0.6;
+    double well = 0.6;
+    double score = 0.02;
+    double burn = -2.0;
+    double b2b = 3.0;
+    double combo = 0.5;
+};
+
+struct BotConfig {
+    size_t depth = num_next_pieces;
+    size_t beam_width = 128;
+    size_t threads = 0; // 0 means one per hardware thread
+    BotWeights weights{};
+};
+
+struct BotMove {
+    bool use_hold;
+    Placement placement;
+};
+
+// Beam search over the hold piece and the visible preview. Each depth expands every beam node with the placements of
+// the current piece (and of the piece it could swap with through hold), keeps the best `beam_width` children by
+// heuristic value, and the first move of the best node at the end is played. Expansion is split across a worker pool,
+// each worker owning a scratch board, a move generator and a child buffer.
+struct Bot {
+    static constexpr size_t num_known_pieces = num_next_pieces + 1;
+
+    struct Node {
+        Rows rows;
+        ScoreState score_state;
+        std::optional<Tetromino> hold_piece;
+        std::optional<Tetromino> current;
+        size_t next_index;
+        BotMove first_move;
+        double reward;
+        double value;
+    };
+
+    struct Scratch {
+        Board board{0};
+        MoveGenerator generator;
+        std::vector<Node> children;
+        size_t nodes = 0;
+    };
+
+    BotConfig config;
+    WorkerPool pool;
+    std::vector<std::unique_ptr<Scratch>> scratch;
+    std::vector<Node> beam;
+    size_t nodes_searched = 0;
+
+    explicit Bot(BotConfig bot_config = {})
+        : config(bot_config),
+          pool(config.threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : config.threads) {
+        for (size_t i = 0; i < pool.size(); i++) {
+            scratch.push_back(std::make_unique<Scratch>());
+        }
+    }
+
+    auto think(Board const& board) -> std::optional<BotMove>;
+    void expand(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces, bool hold_allowed, int level,
+                bool root, Scratch& s) const;
+    [[nodiscard]] auto evaluate(Node const& node) const -> double;
+    static void play(Board& board, BotMove const& move);
+};
+
+inline auto Bot::evaluate(Node const& node) const -> double {
+    BotWeights const& w = config.weights;
+    auto const [heights, holes] = surfaceFeatures(node.rows);
+
+    int height_sum = 0;
+    int max_height = 0;
+    int bumpiness = 0;
+    int deepest_well = 0;
+    for (int c = 0; c < num_cols; c++) {
+        height_sum += heights[c];
+        max_height = std::max(max_height, heights[c]);
+        if (c + 1 < num_cols) {
+            bumpiness += std::abs(heights[c] - heights[c + 1]);
+        }
+        int left = c > 0 ? heights[c - 1] : num_rows;
+        int right = c + 1 < num_cols ? heights[c + 1] : num_rows;
+        deepest_well = std::max(deepest_well, std::min(left, right) - heights[c]);
+    }
+
+    constexpr int safe_height = 12;
+    return w.height * height_sum + w.danger_height * std::max(0, max_height - safe_height) + w.holes * holes +
+           w.bumpiness * bumpiness + w.well * std::min(deepest_well, 4) +
+           (node.score_state.prev_b2b ? w.b2b : 0) + w.combo * std::max(0, node.score_state.combo_count);
+}
+
+inline void Bot::expand(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces, bool hold_allowed,
+                        int level, bool root, Scratch& s) const {
+    if (!node.current.has_value()) {
+        return;
+    }
+    for (bool use_hold : {false, true}) {
+        Tetromino piece = node.current.value();
+        std::optional<Tetromino> hold_piece = node.hold_piece;
+        size_t next_index = node.next_index;
+        if (use_hold) {
+            if (!hold_allowed || hold_piece == node.current) {
+                continue;
+            }
+            if (hold_piece.has_value()) {
+                piece = hold_piece.value();
+            } else if (next_index < num_known_pieces) {
+                piece = pieces[next_index++];
+            } else {
+                continue;
+            }
+            hold_piece = node.current;
+        }
+
+        s.board.rows = node.rows;
+        for (Placement const& placement : s.generator.generate(s.board, piece)) {
+            // Every orientation of O covers the same cells
+            if (piece == Tetromino::O && placement.orientation != Orientation::UP) {
+                continue;
+            }
+            PieceMask const& mask = piece_masks[piece][placement.orientation];
+            if (placement.position.y + mask.max_y < 2) {
+                continue;
+            }
+            s.nodes++;
+            Node& child = s.children.emplace_back(node);
+            child.hold_piece = hold_piece;
+            child.current = next_index < num_known_pieces ? std::optional<Tetromino>{pieces[next_index]} : std::nullopt;
+            child.next_index = next_index + 1;
+            if (root) {
+                child.first_move = BotMove{.use_hold = use_hold, .placement = placement};
+            }
+
+            placePiece(child.rows, piece, placement.position, placement.orientation);
+            size_t lines_cleared = clearFullRows(child.rows);
+            int score_before = child.score_state.current_score;
+            if (lines_cleared == 0) {
+                child.score_state.resetCombo();
+            }
+            std::optional<BaseActionScore> base_action_score = toBaseActionScore(lines_cleared, placement.t_spin);
+            if (base_action_score.has_value()) {
+                child.score_state.score(base_action_score.value(), level, 0, 0,
+                                        lines_cleared > 0 && fieldEmpty(child.rows));
+            }
+            double gain = static_cast<double>(child.score_state.current_score - score_before) / (level + 1);
+            bool burn = lines_cleared > 0 && lines_cleared < 4 && placement.t_spin == TSpinType::NotTSpin;
+            child.reward += config.weights.score * gain +
+                            (burn ? config.weights.burn * static_cast<double>(lines_cleared) : 0);
+            child.value = child.reward + evaluate(child);
+        }
+    }
+}
+
+inline auto Bot::think(Board const& board) -> std::optional<BotMove> {
+    if (!board.running) {
+        return {};
+    }
+    std::array<Tetromino, num_known_pieces> const& pieces = board.curr_and_next_pieces;
+    beam.clear();
+    beam.push_back(Node{.rows = board.rows,
+                        .score_state = board.score_state,
+                        .hold_piece = board.hold_piece,
+                        .current = board.active_piece.type,
+                        .next_index = 1,
+                        .first_move = {},
+                        .reward = 0,
+                        .value = 0});
+
+    std::optional<BotMove> best;
+    size_t depth = std::clamp<size_t>(config.depth, 1, num_known_pieces);
+    for (size_t d = 0; d < depth; d++) {
+        bool const root = d == 0;
+        bool const hold_allowed = !root || !board.just_swapped_hold;
+        auto job = [&](size_t worker) {
+            Scratch& s = *scratch[worker];
+            s.children.clear();
+            for (size_t i = worker; i < beam.size(); i += pool.size()) {
+                expand(beam[i], pieces, hold_allowed, board.level, root, s);
+            }
+        };
+        pool.run(job);
+
+        beam.clear();
+        for (auto& s : scratch) {
+            beam.insert(beam.end(), s->children.begin(), s->children.end());
+            nodes_searched += s->nodes;
+            s->nodes = 0;
+        }
+        if (beam.empty()) {
+            break;
+        }
+        auto by_value = [](Node const& a, Node const& b) { return a.value > b.value; };
+        if (beam.size() > config.beam_width) {
+            std::nth_element(beam.begin(), beam.begin() + static_cast<std::ptrdiff_t>(config.beam_width), beam.end(),
+                             by_value);
+            beam.resize(config.beam_width);
+        }
+        best = std::max_element(beam.begin(), beam.end(), [](Node const& a, Node const& b) {
+                   return a.value < b.value;
+               })->first_move;
+    }
+    return best;
+}
+
+inline void Bot::play(Board& board, BotMove const& move) {
+    if (move.use_hold) {
+        board.holdPiece();
+    }
+    board.active_piece.position = move.placement.position;
+    board.active_piece.orientation = move.placement.orientation;
+    board.last_move = move.placement.t_spin;
+    board.triggerLock(move.placement.t_spin);
+    board.updateGhostPiece();
+}
+
+} // namespace tetris
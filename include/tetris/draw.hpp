@@ -0,0 +1,189 @@
+#pragma once
+
+#include "board.hpp"
+#include "piece.hpp"
+#include "render.hpp"
+#include "tetris.hpp"
+#include "trace.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <glm/ext/vector_int2.hpp>
+#include <vector>
+
+// Encodes a Board into render command buffers. No raylib here, so frames can be encoded headless.
+namespace tetris {
+
+constexpr int cell_size = 30;
+constexpr float offset = 10;
+
+constexpr float hold_width = 130;
+constexpr float next_piece_width = 130;
+constexpr int medium_piece_size = 23;
+constexpr int tiny_piece_size = 17;
+constexpr int top_margin = 77;
+constexpr glm::ivec2 hold_position{hold_width / 2 - 1.5 * medium_piece_size + offset / 2, top_margin};
+constexpr int screen_width = 2 * tetris::offset + tetris::cell_size * tetris::num_cols + hold_width + next_piece_width;
+constexpr int screen_height = 2 * tetris::offset + tetris::cell_size * (tetris::num_rows - 2);
+constexpr glm::ivec2 first_next_position{hold_width + 2 * offset + tetris::cell_size * tetris::num_cols +
+                                             next_piece_width / 2 - 1.5 * medium_piece_size - offset / 2,
+                                         top_margin};
+constexpr glm::ivec2 next_position{hold_width + 2 * offset + tetris::cell_size * tetris::num_cols +
+                                       next_piece_width / 2 - 1.5 * tiny_piece_size - offset / 2,
+                                   top_margin + 7};
+constexpr int next_position_spacing = 60;
+
+constexpr render::Color red = {255, 0, 0, 255};
+constexpr render::Color orange = {255, 135, 0, 255};
+constexpr render::Color yellow = {255, 255, 0, 255};
+constexpr render::Color cyan = {10, 239, 255, 255};
+constexpr render::Color blue = {88, 10, 255, 255};
+constexpr render::Color green = {161, 255, 10, 255};
+constexpr render::Color purple = {190, 10, 255, 255};
+constexpr render::Color gray = {130, 130, 130, 255};
+
+// Indexed by Tetromino, the extra entry is garbage_cell
+constexpr std::array<render::Color, NUM_TETROMINOS + 1> piece_colors = {cyan,  blue,   orange, yellow,
+                                                                        green, purple, red,    gray};
+
+constexpr float cell_roundness = 0.4;
+constexpr int cell_segments = 6;
+
+// Draw order: locked stack and grid, then pieces, then the ghost outline, then text
+enum Layer : uint8_t { StackLayer, PieceLayer, GhostLayer, TextLayer };
+
+inline void drawCell(render::CommandBuffer& buffer, uint8_t layer, Tetromino type, ivec2 pos) {
+    buffer.roundedRectangle(layer, hold_width + offset + static_cast<float>(pos.x) * cell_size,
+                            offset + static_cast<float>(pos.y - 2) * cell_size, cell_size, cell_size, cell_roundness,
+                            cell_segments, piece_colors[type]);
+}
+
+inline void drawPiece(render::CommandBuffer& buffer, Piece const& piece) {
+    for (auto cell : piece_attributes[piece.type].states[piece.orientation]) {
+        ivec2 abs_pos = piece.position + cell;
+        if (abs_pos.y >= 2) {
+            drawCell(buffer, PieceLayer, piece.type, abs_pos);
+        }
+    }
+}
+
+inline void drawGhost(render::CommandBuffer& buffer, Piece const& piece) {
+    for (auto cell : piece_attributes[piece.type].states[piece.orientation]) {
+        ivec2 abs_pos = piece.position + cell;
+        if (abs_pos.y < 2) {
+            continue;
+        }
+        buffer.rectangleLines(GhostLayer, hold_width + offset + static_cast<float>(abs_pos.x) * cell_size - 1,
+                              offset + static_cast<float>(abs_pos.y - 2) * cell_size, cell_size + 1, cell_size + 1, 3,
+                              piece_colors[piece.type]);
+    }
+}
+
+inline void drawTetromino(render::CommandBuffer& buffer, Tetromino t, ivec2 pos, int size) {
+    float nudge_offset = 0;
+    if (t == Tetromino::O) {
+        nudge_offset = 0.5;
+    } else if (t == Tetromino::I) {
+        nudge_offset = -0.5;
+    }
+    for (auto cell : piece_attributes[t].states[Orientation::UP]) {
+        buffer.roundedRectangle(PieceLayer,
+                                static_cast<float>(pos[0]) +
+                                    (static_cast<float>(cell.x) + nudge_offset) * static_cast<float>(size),
+                                static_cast<float>(pos[1] + cell.y * size), static_cast<float>(size),
+                                static_cast<float>(size), cell_roundness, cell_segments, piece_colors[t]);
+    }
+}
+
+inline void drawGrid(render::CommandBuffer& buffer) {
+    constexpr float left = hold_width + offset;
+    constexpr float right = left + num_cols * cell_size;
+    constexpr float bottom = offset + (num_rows - 2) * cell_size;
+    for (int row = 0; row < num_rows - 1; row++) {
+        float y = offset + static_cast<float>(row * cell_size);
+        buffer.line(StackLayer, left, y, right, y, render::dark_gray);
+    }
+    for (int col = 0; col <= num_cols; col++) {
+        float x = left + static_cast<float>(col * cell_size);
+        buffer.line(StackLayer, x, offset, x, bottom, render::dark_gray);
+    }
+}
+
+// Locked cells and the grid, re-encoded only for the rows the board reports dirty. The cached buffer is already sorted
+// and can be submitted as is every frame.
+struct StackCache {
+    std::array<std::vector<render::Command>, num_rows> row_commands;
+    render::CommandBuffer grid;
+    render::CommandBuffer buffer;
+    size_t rows_encoded = 0;
+
+    StackCache() { drawGrid(grid); }
+
+    // Returns true if the cached buffer was rebuilt
+    auto sync(Board& board) -> bool {
+        TRACE_SCOPE("StackCache::sync");
+        uint32_t dirty = board.takeDirtyRows();
+        if (dirty == 0) {
+            return false;
+        }
+        render::CommandBuffer row_buffer;
+        for (; dirty != 0; dirty &= dirty - 1) {
+            int const row = std::countr_zero(dirty);
+            row_buffer.clear();
+            if (row >= 2) {
+                for (int col = 0; col < num_cols; col++) {
+                    if (board.state[row][col].has_value()) {
+                        drawCell(row_buffer, StackLayer, board.state[row][col].value(), ivec2{col, row});
+                    }
+                }
+            }
+            row_commands[row].swap(row_buffer.commands);
+            rows_encoded++;
+        }
+        buffer.clear();
+        for (auto const& commands : row_commands) {
+            for (auto const& command : commands) {
+                buffer.push(command);
+            }
+        }
+        buffer.append(grid);
+        buffer.sort();
+        return true;
+    }
+};
+
+// Per-frame layers: previews, hold, active and ghost piece and the labels
+inline void drawDynamic(render::CommandBuffer& buffer, Board const& board) {
+    TRACE_SCOPE("drawDynamic");
+    if (board.hold_piece.has_value()) {
+        drawTetromino(buffer, board.hold_piece.value(), hold_position, medium_piece_size);
+    }
+
+    drawTetromino(buffer, board.curr_and_next_pieces[1], first_next_position, medium_piece_size);
+    for (int i = 1; i < num_next_pieces; i++) {
+        drawTetromino(buffer, board.curr_and_next_pieces[i + 1], next_position + i * ivec2{0, next_position_spacing},
+                      tiny_piece_size);
+    }
+
+    if (!board.running) {
+        return;
+    }
+    drawPiece(buffer, board.active_piece);
+    drawGhost(buffer, board.ghost_piece);
+
+    buffer.text(TextLayer, "Hold", 45, 35, 20, render::white);
+    buffer.text(TextLayer, "Next", 485, 35, 20, render::white);
+    buffer.textf(TextLayer, 30, 500, 20, render::white, "Level: %i", board.level + 1);
+    buffer.textf(TextLayer, 20, 550, 20, render::white, "Score: %i", board.score_state.current_score);
+}
+
+// Brings the stack cache up to date and encodes the dynamic part of the frame into `frame`, sorted for submission
+inline void drawBoard(render::CommandBuffer& frame, StackCache& stack, Board& board) {
+    TRACE_SCOPE("drawBoard");
+    stack.sync(board);
+    frame.clear();
+    drawDynamic(frame, board);
+    frame.sort();
+}
+
+} // namespace tetris
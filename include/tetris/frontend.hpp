@@ -0,0 +1,63 @@
+#pragma once
+
+#include "draw.hpp"
+#include "input.hpp"
+#include "raylib.h"
+#include "render_raylib.hpp"
+#include <array>
+#include <optional>
+#include <utility>
+
+// raylib front-end: keyboard sampling, and frame encoding from draw.hpp replayed through the raylib backend
+namespace tetris {
+
+// In the order events from the same poll are handled
+constexpr std::array<std::pair<Key, int>, static_cast<size_t>(Key::NumKeys)> key_bindings = {{
+    {Key::Hold, KEY_LEFT_SHIFT},
+    {Key::RotateAnticlockwise, KEY_Z},
+    {Key::RotateClockwise, KEY_X},
+    {Key::HardDrop, KEY_SPACE},
+    {Key::SoftDrop, KEY_DOWN},
+    {Key::Left, KEY_LEFT},
+    {Key::Right, KEY_RIGHT},
+}};
+
+// Turns raylib's keyboard state into input events. raylib only exposes the keyboard once per frame, so events carry the
+// time of the poll. Presses are read from raylib's pressed-key queue, so a tap that starts and ends between two polls
+// still arrives as a press and a release.
+struct KeyboardSampler {
+    std::array<bool, static_cast<size_t>(Key::NumKeys)> down{};
+
+    static auto bindingOf(int code) -> std::optional<Key> {
+        for (auto const& [key, key_code] : key_bindings) {
+            if (key_code == code) {
+                return key;
+            }
+        }
+        return {};
+    }
+
+    void poll(double time, InputEventQueue& events) {
+        for (int code = GetKeyPressed(); code != 0; code = GetKeyPressed()) {
+            std::optional<Key> key = bindingOf(code);
+            if (!key.has_value()) {
+                continue;
+            }
+            bool& is_down = down[static_cast<size_t>(key.value())];
+            if (is_down && !events.push(InputEvent{.time = time, .key = key.value(), .pressed = false})) {
+                continue;
+            }
+            // A press that doesn't fit is lost, the key state catches up below once the queue has room
+            is_down = events.push(InputEvent{.time = time, .key = key.value(), .pressed = true});
+        }
+        for (auto const& [key, key_code] : key_bindings) {
+            bool const now_down = IsKeyDown(key_code);
+            bool& is_down = down[static_cast<size_t>(key)];
+            if (now_down != is_down && events.push(InputEvent{.time = time, .key = key, .pressed = now_down})) {
+                is_down = now_down;
+            }
+        }
+    }
+};
+
+} // namespace tetris
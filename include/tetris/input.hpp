@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace tetris {
+
+// Input for one simulation step. The `_held` fields are level triggered, the rest are edge triggered and should only be
+// set on the step where the key went down.
+struct InputState {
+    bool left_held = false;
+    bool right_held = false;
+    bool soft_drop_held = false;
+    bool rotate_clockwise = false;
+    bool rotate_anticlockwise = false;
+    bool hard_drop = false;
+    bool hold = false;
+
+    auto operator==(InputState const&) const -> bool = default;
+};
+
+enum class Key : uint8_t { Left, Right, SoftDrop, RotateClockwise, RotateAnticlockwise, HardDrop, Hold, NumKeys };
+
+// A key transition and when it happened, on the same clock as the times passed to Board::update
+struct InputEvent {
+    double time;
+    Key key;
+    bool pressed;
+};
+
+// Events waiting to be simulated, in the order they happened. Board::update consumes the ones up to the step time and
+// leaves later ones queued.
+struct InputEventQueue {
+    static constexpr size_t capacity = 64;
+    // Left uninitialised, a queue is built for every frame-polled step
+    std::array<InputEvent, capacity> events;
+    size_t head = 0;
+    size_t size = 0;
+
+    // Drops the event and returns false when the queue is full. Board::update takes everything up to the step time,
+    // so only input queued far ahead of the simulation can fill it.
+    auto push(InputEvent const& event) -> bool {
+        if (size == capacity) {
+            return false;
+        }
+        assert(size == 0 || (*this)[size - 1].time <= event.time);
+        events[(head + size) % capacity] = event;
+        size++;
+        return true;
+    }
+
+    auto pop() -> std::optional<InputEvent> {
+        if (size == 0) {
+            return {};
+        }
+        InputEvent event = events[head];
+        head = (head + 1) % capacity;
+        size--;
+        return event;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return size == 0; }
+    [[nodiscard]] auto front() const -> InputEvent const& { return events[head]; }
+    auto operator[](size_t i) -> InputEvent& { return events[(head + i) % capacity]; }
+    auto operator[](size_t i) const -> InputEvent const& { return events[(head + i) % capacity]; }
+
+    void clear() {
+        head = 0;
+        size = 0;
+    }
+};
+
+// Turns the difference between two per-step InputState snapshots into events stamped `time`. Within a step they are
+// ordered hold, rotation, drops, then shifts, the order Board used to handle a snapshot in. At most six events are
+// added, callers pass a queue that is emptied every step so they always fit.
+inline void pushInputChanges(InputState const& previous, InputState const& current, double time,
+                             InputEventQueue& events) {
+    if (current.hold) {
+        events.push(InputEvent{.time = time, .key = Key::Hold, .pressed = true});
+    }
+    if (current.rotate_anticlockwise) {
+        events.push(InputEvent{.time = time, .key = Key::RotateAnticlockwise, .pressed = true});
+    } else if (current.rotate_clockwise) {
+        events.push(InputEvent{.time = time, .key = Key::RotateClockwise, .pressed = true});
+    }
+    if (current.hard_drop) {
+        events.push(InputEvent{.time = time, .key = Key::HardDrop, .pressed = true});
+    }
+    if (current.soft_drop_held != previous.soft_drop_held) {
+        events.push(InputEvent{.time = time, .key = Key::SoftDrop, .pressed = current.soft_drop_held});
+    }
+    if (current.left_held != previous.left_held) {
+        events.push(InputEvent{.time = time, .key = Key::Left, .pressed = current.left_held});
+    }
+    if (current.right_held != previous.right_held) {
+        events.push(InputEvent{.time = time, .key = Key::Right, .pressed = current.right_held});
+    }
+}
+
+} // namespace tetris
@@ -0,0 +1,482 @@
+#pragma once
+
+#include "board.hpp"
+#include "input.hpp"
+#include "net.hpp"
+#include "replay.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Authoritative match server. Each connection can host one match, a Board that the server steps on a fixed tick from
+// the inputs the client sends. The main thread runs the epoll loop: it accepts connections and queues inputs between
+// ticks. On each timer expiry the worker pool steps every live board in batches and encodes the deltas, which the main
+// thread then writes out. See net.hpp for the protocol.
+namespace tetris {
+
+struct ServerConfig {
+    uint16_t port = 7777;
+    int tick_hz = 60;
+    // Game seconds per real second, above 1 to get through more matches in a load test
+    double speed = 1;
+    size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    // Inputs stamped further ahead of the match clock are pulled back to this
+    double max_input_lead = 0.25;
+    // A client that lets this much output pile up is disconnected
+    size_t max_pending_output = size_t{1} << 20;
+};
+
+// What the last Delta told the client about the active piece, hold and score
+struct PieceView {
+    uint8_t type;
+    uint8_t orientation;
+    int8_t x;
+    int8_t y;
+    uint8_t hold;
+
+    auto operator==(PieceView const&) const -> bool = default;
+};
+
+struct Connection {
+    int fd;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    size_t out_sent = 0;
+    bool closed = false;
+    bool write_armed = false;
+
+    std::optional<Board> board;
+    uint64_t start_tick = 0;
+    InputEventQueue events;
+    // Echo of each queued event, a ring that moves in step with `events`
+    std::array<uint32_t, InputEventQueue::capacity> echoes{};
+    size_t echo_head = 0;
+    // Newest consumed input, and whether the client has been told
+    uint32_t echo = 0;
+    bool echo_changed = false;
+    PieceView sent_piece{};
+    int sent_score = -1;
+
+    explicit Connection(int socket) : fd(socket) {}
+};
+
+struct MatchServer {
+    // Sessions handed to a worker at a time
+    static constexpr size_t batch_size = 32;
+
+    ServerConfig config;
+    WorkerPool pool;
+    int epoll_fd = -1;
+    int listen_fd = -1;
+    int timer_fd = -1;
+    double game_seconds_per_tick;
+    std::vector<std::unique_ptr<Connection>> connections;
+    // Connections with a match, rebuilt every tick
+    std::vector<Connection*> live;
+
+    uint64_t ticks = 0;
+    uint64_t sessions = 0;
+    uint64_t dropped_inputs = 0;
+    uint64_t bytes_sent = 0;
+    std::atomic<uint64_t> matches{0};
+    std::vector<uint32_t> tick_us;
+
+    explicit MatchServer(ServerConfig const& server_config)
+        : config(server_config), pool(server_config.threads),
+          game_seconds_per_tick(server_config.speed / server_config.tick_hz) {}
+    MatchServer(MatchServer const&) = delete;
+    MatchServer(MatchServer&&) = delete;
+    auto operator=(MatchServer const&) -> MatchServer& = delete;
+    auto operator=(MatchServer&&) -> MatchServer& = delete;
+    ~MatchServer();
+
+    // Listens on the loopback interface. False with errno set if a socket call fails.
+    auto open() -> bool;
+    // Serves until `stop` is set
+    void run(std::atomic<bool> const& stop);
+    void acceptAll();
+    void readFrom(Connection& c);
+    void handleMessage(Connection& c, MessageType type, FrameReader& reader);
+    void queueInput(Connection& c, uint32_t time_us, uint8_t packed, uint32_t echo);
+    void tick();
+    void step(Connection& c);
+    void writeDelta(Connection& c) const;
+    void flush(Connection& c);
+    void close(Connection& c);
+    [[nodiscard]] auto tickPercentile(size_t p) const -> uint32_t;
+    [[nodiscard]] static auto cpuMicroseconds() -> uint64_t;
+    void writeSummary(std::ostream& out) const;
+};
+
+inline MatchServer::~MatchServer() {
+    for (auto& c : connections) {
+        if (!c->closed) {
+            ::close(c->fd);
+        }
+    }
+    for (int fd : {timer_fd, listen_fd, epoll_fd}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+inline auto MatchServer::open() -> bool {
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listen_fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, SOMAXCONN) != 0) {
+        return false;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (timer_fd < 0) {
+        return false;
+    }
+    long const period_ns = 1'000'000'000L / config.tick_hz;
+    itimerspec period{};
+    period.it_interval.tv_sec = period_ns / 1'000'000'000L;
+    period.it_interval.tv_nsec = period_ns % 1'000'000'000L;
+    period.it_value = period.it_interval;
+    if (timerfd_settime(timer_fd, 0, &period, nullptr) != 0) {
+        return false;
+    }
+
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        return false;
+    }
+    // The listening socket and the timer are told apart from connections by the address of their descriptor
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = &listen_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) != 0) {
+        return false;
+    }
+    event.data.ptr = &timer_fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) == 0;
+}
+
+inline void MatchServer::run(std::atomic<bool> const& stop) {
+    std::array<epoll_event, 256> ready{};
+    while (!stop.load(std::memory_order_relaxed)) {
+        // The timeout only bounds how long a stop request waits
+        int const n = epoll_wait(epoll_fd, ready.data(), static_cast<int>(ready.size()), 100);
+        for (int i = 0; i < n; i++) {
+            void* const tag = ready[i].data.ptr;
+            if (tag == &listen_fd) {
+                acceptAll();
+            } else if (tag == &timer_fd) {
+                uint64_t expirations = 0;
+                if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    // Ticks missed while busy are caught up, the match clocks follow real time
+                    for (uint64_t e = 0; e < expirations; e++) {
+                        tick();
+                    }
+                }
+            } else {
+                Connection& c = *static_cast<Connection*>(tag);
+                uint32_t const events = ready[i].events;
+                if (!c.closed && (events & EPOLLIN) != 0) {
+                    readFrom(c);
+                }
+                if (!c.closed && (events & EPOLLOUT) != 0) {
+                    flush(c);
+                }
+                if (!c.closed && (events & (EPOLLERR | EPOLLHUP)) != 0) {
+                    close(c);
+                }
+            }
+        }
+        // Deferred so that no event of this batch refers to a freed connection
+        std::erase_if(connections, [](auto const& c) { return c->closed; });
+    }
+}
+
+inline void MatchServer::acceptAll() {
+    while (true) {
+        int const fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            // EAGAIN once the backlog is empty. Out of descriptors the rest wait until a connection closes.
+            return;
+        }
+        setNoDelay(fd);
+        auto& c = connections.emplace_back(std::make_unique<Connection>(fd));
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = c.get();
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(*c);
+        }
+    }
+}
+
+inline void MatchServer::readFrom(Connection& c) {
+    std::array<uint8_t, 4096> buffer{};
+    while (true) {
+        ssize_t const n = recv(c.fd, buffer.data(), buffer.size(), 0);
+        if (n > 0) {
+            c.in.insert(c.in.end(), buffer.begin(), buffer.begin() + n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            close(c);
+            return;
+        }
+        break;
+    }
+    size_t const consumed = forEachFrame(c.in, [&](MessageType type, FrameReader reader) {
+        if (!c.closed) {
+            handleMessage(c, type, reader);
+        }
+    });
+    c.in.erase(c.in.begin(), c.in.begin() + static_cast<std::ptrdiff_t>(consumed));
+    flush(c);
+}
+
+inline void MatchServer::handleMessage(Connection& c, MessageType type, FrameReader& reader) {
+    switch (type) {
+    case MessageType::Hello: {
+        uint32_t const seed = reader.u32();
+        uint8_t const randomizer = reader.u8();
+        if (!reader.ok || randomizer > static_cast<uint8_t>(RandomizerKind::Mt19937)) {
+            break;
+        }
+        c.board.emplace(seed, static_cast<RandomizerKind>(randomizer));
+        c.start_tick = ticks;
+        c.events.clear();
+        c.echo_head = 0;
+        c.echo_changed = false;
+        c.sent_score = -1;
+        sessions++;
+        size_t const frame = beginFrame(c.out, MessageType::Welcome);
+        putU32(c.out, static_cast<uint32_t>(toMicroseconds(game_seconds_per_tick)));
+        endFrame(c.out, frame);
+        return;
+    }
+    case MessageType::Input: {
+        uint32_t const time_us = reader.u32();
+        uint8_t const packed = reader.u8();
+        uint32_t const echo = reader.u32();
+        if (!reader.ok || packed >> 1U >= static_cast<uint8_t>(Key::NumKeys)) {
+            break;
+        }
+        queueInput(c, time_us, packed, echo);
+        return;
+    }
+    case MessageType::StatsRequest: {
+        size_t const frame = beginFrame(c.out, MessageType::Stats);
+        putU64(c.out, cpuMicroseconds());
+        putU64(c.out, ticks);
+        putU64(c.out, matches.load(std::memory_order_relaxed));
+        putU32(c.out, static_cast<uint32_t>(connections.size()));
+        putU32(c.out, tickPercentile(50));
+        putU32(c.out, tickPercentile(99));
+        putU32(c.out, tickPercentile(100));
+        endFrame(c.out, frame);
+        return;
+    }
+    default:
+        break;
+    }
+    // Malformed or not a client message
+    close(c);
+}
+
+// The server's clock is authoritative: an input stamped before the board's current time, or before an input already
+// queued, takes effect at that time instead, and one stamped too far ahead is pulled back
+inline void MatchServer::queueInput(Connection& c, uint32_t time_us, uint8_t packed, uint32_t echo) {
+    if (!c.board.has_value()) {
+        return;
+    }
+    if (c.events.size == InputEventQueue::capacity) {
+        dropped_inputs++;
+        return;
+    }
+    double const match_now = static_cast<double>(ticks - c.start_tick) * game_seconds_per_tick;
+    double const earliest = c.events.empty() ? c.board->current_time : c.events[c.events.size - 1].time;
+    double const time = std::clamp(toSeconds(time_us), earliest, std::max(earliest, match_now + config.max_input_lead));
+    c.echoes[(c.echo_head + c.events.size) % InputEventQueue::capacity] = echo;
+    c.events.push(InputEvent{.time = time, .key = static_cast<Key>(packed >> 1U), .pressed = (packed & 1U) != 0});
+}
+
+inline void MatchServer::tick() {
+    auto const start = std::chrono::steady_clock::now();
+    ticks++;
+    live.clear();
+    for (auto& c : connections) {
+        if (!c->closed && c->board.has_value()) {
+            live.push_back(c.get());
+        }
+    }
+    std::atomic<size_t> next{0};
+    auto job = [&](size_t /*worker*/) {
+        for (size_t k = next.fetch_add(batch_size); k < live.size(); k = next.fetch_add(batch_size)) {
+            for (size_t i = k; i < std::min(k + batch_size, live.size()); i++) {
+                step(*live[i]);
+            }
+        }
+    };
+    pool.run(job);
+    for (Connection* c : live) {
+        flush(*c);
+    }
+    tick_us.push_back(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+// Runs on a worker. Touches only the connection's own board and output buffer.
+inline void MatchServer::step(Connection& c) {
+    Board& board = c.board.value();
+    double const now = static_cast<double>(ticks - c.start_tick) * game_seconds_per_tick;
+    size_t const queued = c.events.size;
+    board.update(now, c.events);
+    size_t const consumed = queued - c.events.size;
+    if (consumed > 0) {
+        c.echo = c.echoes[(c.echo_head + consumed - 1) % InputEventQueue::capacity];
+        c.echo_head = (c.echo_head + consumed) % InputEventQueue::capacity;
+        c.echo_changed = true;
+    }
+    // Nobody displays them here
+    while (board.score_events.pop().has_value()) {
+    }
+    if (board.running) {
+        writeDelta(c);
+        return;
+    }
+    size_t const frame = beginFrame(c.out, MessageType::GameOver);
+    putU32(c.out, static_cast<uint32_t>(board.score_state.current_score));
+    putU32(c.out, static_cast<uint32_t>(board.total_lines_cleared));
+    putU32(c.out, static_cast<uint32_t>(board.pieces_locked));
+    endFrame(c.out, frame);
+    c.board.reset();
+    c.events.clear();
+    c.echo_head = 0;
+    matches.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Skipped on ticks where nothing the client can see has changed
+inline void MatchServer::writeDelta(Connection& c) const {
+    Board& board = c.board.value();
+    uint32_t const dirty = board.takeDirtyRows();
+    Piece const& piece = board.active_piece;
+    PieceView const view{
+        .type = static_cast<uint8_t>(piece.type),
+        .orientation = static_cast<uint8_t>(piece.orientation),
+        .x = static_cast<int8_t>(piece.position.x),
+        .y = static_cast<int8_t>(piece.position.y),
+        .hold = static_cast<uint8_t>(board.hold_piece.has_value() ? board.hold_piece.value() + 1 : 0),
+    };
+    int const score = board.score_state.current_score;
+    if (dirty == 0 && view == c.sent_piece && score == c.sent_score && !c.echo_changed) {
+        return;
+    }
+    c.sent_piece = view;
+    c.sent_score = score;
+    c.echo_changed = false;
+
+    size_t const frame = beginFrame(c.out, MessageType::Delta);
+    putU32(c.out, static_cast<uint32_t>(toMicroseconds(board.current_time)));
+    putU32(c.out, c.echo);
+    putU8(c.out, view.type);
+    putU8(c.out, view.orientation);
+    putU8(c.out, static_cast<uint8_t>(view.x));
+    putU8(c.out, static_cast<uint8_t>(view.y));
+    putU8(c.out, view.hold);
+    putU32(c.out, static_cast<uint32_t>(score));
+    putU16(c.out, static_cast<uint16_t>(std::min<size_t>(board.total_lines_cleared, UINT16_MAX)));
+    putU32(c.out, dirty);
+    for (uint32_t rows = dirty; rows != 0; rows &= rows - 1) {
+        auto const& row = board.state[std::countr_zero(rows)];
+        for (size_t col = 0; col < row.size(); col += 2) {
+            auto nibble = [&row](size_t i) { return row[i].has_value() ? row[i].value() + 1U : 0U; };
+            putU8(c.out, static_cast<uint8_t>(nibble(col) | nibble(col + 1) << 4U));
+        }
+    }
+    endFrame(c.out, frame);
+}
+
+inline void MatchServer::flush(Connection& c) {
+    if (c.closed || c.out.empty()) {
+        return;
+    }
+    size_t const before = c.out.size() - c.out_sent;
+    if (!flushSocket(c.fd, c.out, c.out_sent) || c.out.size() - c.out_sent > config.max_pending_output) {
+        close(c);
+        return;
+    }
+    bytes_sent += before - (c.out.size() - c.out_sent);
+    bool const pending = !c.out.empty();
+    if (pending != c.write_armed) {
+        epoll_event event{};
+        event.events = EPOLLIN | (pending ? EPOLLOUT : 0U);
+        event.data.ptr = &c;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c.fd, &event);
+        c.write_armed = pending;
+    }
+}
+
+inline void MatchServer::close(Connection& c) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, nullptr);
+    ::close(c.fd);
+    c.closed = true;
+    c.board.reset();
+}
+
+// Nearest rank over every tick so far, 100 gives the maximum
+inline auto MatchServer::tickPercentile(size_t p) const -> uint32_t {
+    if (tick_us.empty()) {
+        return 0;
+    }
+    std::vector<uint32_t> sorted = tick_us;
+    size_t const rank = std::max<size_t>((p * sorted.size() + 99) / 100, 1) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+    return sorted[rank];
+}
+
+inline auto MatchServer::cpuMicroseconds() -> uint64_t {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto micros = [](timeval t) { return static_cast<uint64_t>(t.tv_sec) * 1'000'000 + t.tv_usec; };
+    return micros(usage.ru_utime) + micros(usage.ru_stime);
+}
+
+inline void MatchServer::writeSummary(std::ostream& out) const {
+    double const cpu_seconds = static_cast<double>(cpuMicroseconds()) * 1e-6;
+    uint64_t const completed = matches.load(std::memory_order_relaxed);
+    out << "ticks: " << ticks << " tick p50/p99/max us: " << tickPercentile(50) << "/" << tickPercentile(99) << "/"
+        << tickPercentile(100) << "\n";
+    out << "sessions: " << sessions << " matches completed: " << completed << " dropped inputs: " << dropped_inputs
+        << " bytes sent: " << bytes_sent << "\n";
+    out << "cpu: " << cpu_seconds << "s matches per cpu second: " << static_cast<double>(completed) / cpu_seconds
+        << std::endl;
+}
+
+} // namespace tetris
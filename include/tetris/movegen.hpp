@@ -0,0 +1,203 @@
+#pragma once
+
+#include "board.hpp"
+#include "score.hpp"
+#include "tetris.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/vector_int2.hpp>
+#include <optional>
+#include <span>
+
+namespace tetris {
+
+struct Placement {
+    ivec2 position;
+    Orientation orientation;
+    TSpinType t_spin;
+};
+
+// Enumerates every resting placement reachable from spawn with shifts, soft drops and SRS rotations (same kick tests and
+// T-spin rules as Board::handleRotationTests). A placement reached both by a rotation and by a plain move is reported
+// once per T-spin classification. Symmetric orientations of I/S/Z/O are not merged.
+//
+// Each call first builds a collision map (a bitboard per orientation of the positions where the piece would overlap the
+// stack), so every move and kick test during the search is a single bit test. All scratch space lives in the generator,
+// so generate() does not allocate. Keep one generator per thread and reuse it.
+struct MoveGenerator {
+    // Valid positions keep every cell on the board: x in [-2, num_cols), y in [-2, num_rows)
+    static constexpr int y_offset = cells_in_tetromino - 1;
+    static constexpr int position_rows = num_rows + y_offset;
+    static constexpr size_t max_states = Orientation::NUM_ORIENTATIONS * position_rows * sizeof(Row) * 8;
+    static constexpr size_t num_t_spin_types = 3;
+    static constexpr size_t max_placements = max_states * num_t_spin_types;
+
+    using StateSet = std::array<std::array<Row, position_rows>, Orientation::NUM_ORIENTATIONS>;
+
+    struct Node {
+        int8_t x;
+        int8_t y;
+        uint8_t orientation;
+    };
+
+    std::array<Node, max_states> queue{};
+    StateSet blocked{};
+    StateSet visited{};
+    std::array<StateSet, num_t_spin_types> emitted{};
+    std::array<Placement, max_placements> placements{};
+    size_t num_placements = 0;
+    size_t states_searched = 0;
+    size_t head = 0;
+    size_t tail = 0;
+
+    auto generate(Board const& board, Tetromino type) -> std::span<Placement const>;
+    // For a board whose rows above `top` are empty, with room to turn a piece above them: the search starts from every
+    // position in the few open rows just above `top` instead of from spawn, skipping the rows the piece falls through.
+    // Any position in open air is reachable from spawn, so the placements that reach below `top` are the same.
+    auto generateBelow(Board const& board, Tetromino type, int top) -> std::span<Placement const>;
+    void reset(Board const& board, Tetromino type);
+    void visit(ivec2 pos, Orientation orientation, TSpinType t_spin);
+    auto search(Tetromino type) -> std::span<Placement const>;
+    void buildCollisionMap(Board const& board, Tetromino type);
+    [[nodiscard]] auto isBlocked(ivec2 pos, Orientation orientation) const -> bool;
+    static auto contains(StateSet const& set, ivec2 pos, Orientation orientation) -> bool;
+    static auto mark(StateSet& set, ivec2 pos, Orientation orientation) -> bool;
+};
+
+inline auto MoveGenerator::contains(StateSet const& set, ivec2 pos, Orientation orientation) -> bool {
+    return (set[orientation][pos.y + y_offset] & static_cast<Row>(1U << (pos.x + wall_width))) != 0;
+}
+
+inline auto MoveGenerator::mark(StateSet& set, ivec2 pos, Orientation orientation) -> bool {
+    if (contains(set, pos, orientation)) {
+        return false;
+    }
+    set[orientation][pos.y + y_offset] |= static_cast<Row>(1U << (pos.x + wall_width));
+    return true;
+}
+
+inline void MoveGenerator::buildCollisionMap(Board const& board, Tetromino type) {
+    // Rows above the board are solid, and so is everything right of the 16 bit row after shifting
+    auto board_row = [&board](int y) -> uint32_t { return y < 0 ? 0xFFFFFFFFU : (board.rows[y] | 0xFFFF0000U); };
+    for (size_t o = 0; o < Orientation::NUM_ORIENTATIONS; o++) {
+        for (int yi = 0; yi < position_rows; yi++) {
+            uint32_t row = 0;
+            for (ivec2 cell : piece_attributes[type].states[o]) {
+                row |= board_row(yi - y_offset + cell.y) >> cell.x;
+            }
+            blocked[o][yi] = static_cast<Row>(row);
+        }
+    }
+}
+
+inline auto MoveGenerator::isBlocked(ivec2 pos, Orientation orientation) const -> bool {
+    int const bit = pos.x + wall_width;
+    int const yi = pos.y + y_offset;
+    if (bit < 0 || bit >= static_cast<int>(sizeof(Row) * 8) || yi < 0 || yi >= position_rows) {
+        return true;
+    }
+    return contains(blocked, pos, orientation);
+}
+
+inline void MoveGenerator::visit(ivec2 pos, Orientation orientation, TSpinType t_spin) {
+    StateSet& emitted_set = emitted[static_cast<size_t>(t_spin)];
+    if (!contains(emitted_set, pos, orientation) && isBlocked(pos + ivec2{0, 1}, orientation)) {
+        mark(emitted_set, pos, orientation);
+        placements[num_placements++] = Placement{.position = pos, .orientation = orientation, .t_spin = t_spin};
+    }
+    if (mark(visited, pos, orientation)) {
+        queue[tail++] = Node{.x = static_cast<int8_t>(pos.x),
+                             .y = static_cast<int8_t>(pos.y),
+                             .orientation = static_cast<uint8_t>(orientation)};
+    }
+}
+
+inline void MoveGenerator::reset(Board const& board, Tetromino type) {
+    num_placements = 0;
+    states_searched = 0;
+    head = 0;
+    tail = 0;
+    visited = {};
+    emitted = {};
+    buildCollisionMap(board, type);
+}
+
+inline auto MoveGenerator::generate(Board const& board, Tetromino type) -> std::span<Placement const> {
+    reset(board, type);
+
+    // Mirrors Board::updateSpawn: the piece may be lifted by up to two rows
+    std::optional<ivec2> spawn_pos;
+    for (int lift = 0; lift <= 2 && !spawn_pos.has_value(); lift++) {
+        ivec2 pos = piece_attributes[type].spawn_pos - ivec2{0, lift};
+        if (!isBlocked(pos, Orientation::UP)) {
+            spawn_pos = pos;
+        }
+    }
+    if (!spawn_pos.has_value()) {
+        return {};
+    }
+    visit(spawn_pos.value(), Orientation::UP, TSpinType::NotTSpin);
+    return search(type);
+}
+
+inline auto MoveGenerator::generateBelow(Board const& board, Tetromino type, int top) -> std::span<Placement const> {
+    reset(board, type);
+    // A kick moves a piece down at most two rows, so every state a rotation below `top` can start from has its lowest
+    // cell within the seed band
+    constexpr int seed_rows = cells_in_tetromino + 1;
+    // O never rotates out of its spawn orientation
+    size_t const orientations = type == Tetromino::O ? 1 : static_cast<size_t>(Orientation::NUM_ORIENTATIONS);
+    for (size_t o = 0; o < orientations; o++) {
+        auto const orientation = static_cast<Orientation>(o);
+        PieceMask const& mask = piece_masks[type][o];
+        for (int bottom = top - seed_rows; bottom < top; bottom++) {
+            for (int x = -mask.min_x; x + mask.max_x < num_cols; x++) {
+                ivec2 const pos{x, bottom - mask.max_y};
+                if (!isBlocked(pos, orientation)) {
+                    visit(pos, orientation, TSpinType::NotTSpin);
+                }
+            }
+        }
+    }
+    return search(type);
+}
+
+inline auto MoveGenerator::search(Tetromino type) -> std::span<Placement const> {
+    while (head < tail) {
+        Node const node = queue[head++];
+        ivec2 const pos{node.x, node.y};
+        auto const orientation = static_cast<Orientation>(node.orientation);
+        states_searched++;
+
+        for (ivec2 translation : {ivec2{-1, 0}, ivec2{1, 0}, ivec2{0, 1}}) {
+            if (!isBlocked(pos + translation, orientation)) {
+                visit(pos + translation, orientation, TSpinType::NotTSpin);
+            }
+        }
+        if (type == Tetromino::O) {
+            continue;
+        }
+        // Same kick order and T-spin classification as Board::rotationTest / handleRotationTests
+        WallTests const& wall_tests = type == I ? wall_kick_tests_i : wall_kick_tests_not_i;
+        for (bool clockwise : {false, true}) {
+            Orientation new_orientation = clockwise ? orientation++ : orientation--;
+            bool first_test = true;
+            for (ivec2 const& wall_test : wall_tests[orientation][static_cast<size_t>(clockwise)]) {
+                ivec2 new_position{pos.x + wall_test.x, pos.y - wall_test.y};
+                if (!isBlocked(new_position, new_orientation)) {
+                    TSpinType t_spin = TSpinType::NotTSpin;
+                    if (type == Tetromino::T) {
+                        t_spin = first_test ? TSpinType::NoWallKick : TSpinType::WallKick;
+                    }
+                    visit(new_position, new_orientation, t_spin);
+                    break;
+                }
+                first_test = false;
+            }
+        }
+    }
+    return {placements.data(), num_placements};
+}
+
+} // namespace tetris
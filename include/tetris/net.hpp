@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <span>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <vector>
+
+// Wire protocol of the match server, TCP on POSIX sockets. Every message is a frame:
+//
+//   payload length u16 | type u8 | payload
+//
+// Integers are little-endian. Client to server:
+//
+//   Hello          seed u32 | randomizer u8                starts a match, abandoning the current one
+//   Input          time_us u32 | key << 1 | pressed u8 | echo u32
+//   StatsRequest
+//
+// Server to client:
+//
+//   Welcome        game_us_per_tick u32
+//   Delta          time_us u32 | echo u32 | piece type u8 | orientation u8 | x i8 | y i8 | hold u8 | score u32 |
+//                  lines u16 | dirty rows u32 | per dirty row, top first: one nibble per cell, 0 empty, else type + 1
+//   GameOver       score u32 | lines u32 | pieces u32
+//   Stats          cpu_us u64 | ticks u64 | matches u64 | sessions u32 | tick p50, p99, max us u32
+//
+// Input times are on the match clock, which starts at 0 with the Welcome. A Delta is sent on the ticks where something
+// changed and carries the echo of the newest input the board has consumed, so a client can time its inputs.
+namespace tetris {
+
+enum class MessageType : uint8_t { Hello = 1, Input, StatsRequest, Welcome, Delta, GameOver, Stats };
+
+constexpr size_t frame_header_size = 3;
+
+inline void putU8(std::vector<uint8_t>& out, uint8_t value) { out.push_back(value); }
+
+inline void putU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+inline void putU32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+inline void putU64(std::vector<uint8_t>& out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+// Returns where the frame starts, to be passed to endFrame once the payload is written
+inline auto beginFrame(std::vector<uint8_t>& out, MessageType type) -> size_t {
+    size_t const start = out.size();
+    putU16(out, 0);
+    putU8(out, static_cast<uint8_t>(type));
+    return start;
+}
+
+inline void endFrame(std::vector<uint8_t>& out, size_t start) {
+    size_t const length = out.size() - start - frame_header_size;
+    out[start] = static_cast<uint8_t>(length);
+    out[start + 1] = static_cast<uint8_t>(length >> 8);
+}
+
+// Reads a payload front to back. Reading past the end yields zeros and clears `ok`.
+struct FrameReader {
+    std::span<uint8_t const> payload;
+    size_t pos = 0;
+    bool ok = true;
+
+    auto u8() -> uint8_t {
+        if (pos >= payload.size()) {
+            ok = false;
+            return 0;
+        }
+        return payload[pos++];
+    }
+    auto u16() -> uint16_t {
+        uint16_t const low = u8();
+        return static_cast<uint16_t>(low | u8() << 8);
+    }
+    auto u32() -> uint32_t {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<uint32_t>(u8()) << (8 * i);
+        }
+        return value;
+    }
+    auto u64() -> uint64_t {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= static_cast<uint64_t>(u8()) << (8 * i);
+        }
+        return value;
+    }
+};
+
+// Calls f(type, reader) for every complete frame at the front of `buffer` and returns the number of bytes they take.
+// An incomplete frame at the end is left for the next call.
+template <typename F> auto forEachFrame(std::span<uint8_t const> buffer, F&& f) -> size_t {
+    size_t pos = 0;
+    while (buffer.size() - pos >= frame_header_size) {
+        size_t const length = buffer[pos] | static_cast<size_t>(buffer[pos + 1]) << 8;
+        if (buffer.size() - pos - frame_header_size < length) {
+            break;
+        }
+        auto const type = static_cast<MessageType>(buffer[pos + 2]);
+        f(type, FrameReader{.payload = buffer.subspan(pos + frame_header_size, length)});
+        pos += frame_header_size + length;
+    }
+    return pos;
+}
+
+inline auto setNonBlocking(int fd) -> bool {
+    int const flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Frames are small and latency matters more than packet count
+inline void setNoDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// Thousands of connections need more descriptors than the usual soft limit of 1024
+inline void raiseFileLimit() {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// Writes as much of out[sent..] as the socket takes. False when the connection is broken.
+inline auto flushSocket(int fd, std::vector<uint8_t>& out, size_t& sent) -> bool {
+    while (sent < out.size()) {
+        ssize_t const n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    out.clear();
+    sent = 0;
+    return true;
+}
+
+} // namespace tetris
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "board.hpp"
+#include "bot.hpp"
+#include "movegen.hpp"
+#include "tetris.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace tetris {
+
+struct PerfectClearConfig {
+    // Most pieces the sequence may use, capped by the known pieces: hold, the active piece and the preview
+    size_t max_pieces = num_next_pieces + 2;
+    // Lines cleared by the perfect clear, at most 4
+    int max_lines = 4;
+    size_t threads = 0; // 0 means one per hardware thread
+    // log2 of the transposition table size, 8 bytes per entry
+    size_t table_bits = 18;
+};
+
+struct PerfectClear {
+    std::vector<BotMove> moves;
+    int lines;
+};
+
+// Searches the known pieces for a sequence of placements that empties the board. The target height is fixed up front:
+// filled cells plus 4 per piece must make whole lines, so only heights where (10 * lines - cells) is a multiple of 4
+// are tried, lowest first, and no piece may stick out above that height. The same cell-count parity argument is applied
+// to each part of the field walled off by filled columns. Below it, a state is the bitboard of the
+// bottom rows, the position in the queue and the hold piece; those fit exactly in 50 bits, so the transposition table
+// stores states that were searched without success and never confuses two of them. Failure does not depend on the path
+// that reached a state, so the table is shared by all workers. The root moves are split over the worker pool and the
+// lowest root move with a solution wins, which makes the answer independent of the thread count.
+struct PerfectClearFinder {
+    static constexpr size_t num_known_pieces = num_next_pieces + 1;
+    static constexpr int max_supported_lines = 4;
+    static constexpr int key_bits = 50;
+    static constexpr size_t max_probes = 8;
+    // Positions of one piece inside the bottom four rows: four orientations, at most 4 rows and 13 columns each
+    static constexpr size_t max_distinct_placements = Orientation::NUM_ORIENTATIONS * max_supported_lines * 13;
+
+    struct Node {
+        Rows rows;
+        std::optional<Tetromino> hold_piece;
+        std::optional<Tetromino> current;
+        size_t next_index;
+        // Lines still to clear
+        int lines;
+    };
+
+    struct Scratch {
+        Board board{0};
+        MoveGenerator generator;
+        std::vector<BotMove> path;
+        size_t nodes = 0;
+    };
+
+    PerfectClearConfig config;
+    WorkerPool pool;
+    std::vector<std::unique_ptr<Scratch>> scratch;
+    // Entries are (generation << key_bits | key), stale generations count as empty
+    std::unique_ptr<std::atomic<uint64_t>[]> table;
+    uint64_t generation = 0;
+    size_t nodes_searched = 0;
+
+    explicit PerfectClearFinder(PerfectClearConfig finder_config = {})
+        : config(finder_config),
+          pool(config.threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : config.threads),
+          table(std::make_unique<std::atomic<uint64_t>[]>(size_t{1} << config.table_bits)) {
+        for (size_t i = 0; i < pool.size(); i++) {
+            scratch.push_back(std::make_unique<Scratch>());
+        }
+    }
+
+    auto find(Board const& board) -> std::optional<PerfectClear>;
+
+    [[nodiscard]] static auto key(Node const& node) -> uint64_t;
+    [[nodiscard]] auto knownFailure(uint64_t node_key) const -> bool;
+    void recordFailure(uint64_t node_key);
+    template <typename F>
+    void forEachChild(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces, bool hold_allowed,
+                      Scratch& s, F&& f) const;
+    auto search(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces, Scratch& s) -> bool;
+};
+
+inline auto filledCells(Rows const& rows) -> int {
+    constexpr Row field = static_cast<Row>(~empty_row);
+    int cells = 0;
+    for (int y = 0; y < num_rows; y++) {
+        cells += std::popcount(static_cast<Row>(rows[y] & field));
+    }
+    return cells;
+}
+
+// A column filled over all target rows stays filled until the last line clears, so no piece can cross it. Each part
+// between such columns must be filled by whole pieces: its empty cell count has to be a multiple of 4.
+inline auto separatedPartsFillable(Rows const& rows, int lines) -> bool {
+    constexpr Row field = static_cast<Row>(~empty_row);
+    Row full_columns = field;
+    for (int y = num_rows - lines; y < num_rows; y++) {
+        full_columns &= rows[y];
+    }
+    Row part = 0;
+    for (int col = 0; col <= num_cols; col++) {
+        Row const bit = col < num_cols ? cellBit(col) : 0;
+        if (col < num_cols && (full_columns & bit) == 0) {
+            part |= bit;
+            continue;
+        }
+        int empty = 0;
+        for (int y = num_rows - lines; y < num_rows; y++) {
+            empty += std::popcount(static_cast<Row>(~rows[y] & part));
+        }
+        if (empty % cells_in_tetromino != 0) {
+            return false;
+        }
+        part = 0;
+    }
+    return true;
+}
+
+inline auto PerfectClearFinder::key(Node const& node) -> uint64_t {
+    uint64_t k = 0;
+    for (int y = num_rows - max_supported_lines; y < num_rows; y++) {
+        k = k << num_cols | ((node.rows[y] >> wall_width) & ((1U << num_cols) - 1));
+    }
+    k = k << 4 | node.next_index;
+    k = k << 3 | (node.hold_piece.has_value() ? node.hold_piece.value() : NUM_TETROMINOS);
+    k = k << 3 | static_cast<uint64_t>(node.lines);
+    return k;
+}
+
+inline auto PerfectClearFinder::knownFailure(uint64_t node_key) const -> bool {
+    size_t const mask = (size_t{1} << config.table_bits) - 1;
+    uint64_t const entry = generation << key_bits | node_key;
+    size_t slot = (node_key * 0x9E3779B97F4A7C15ULL) >> (64 - config.table_bits);
+    for (size_t probe = 0; probe < max_probes; probe++, slot = (slot + 1) & mask) {
+        uint64_t const stored = table[slot].load(std::memory_order_relaxed);
+        if (stored == entry) {
+            return true;
+        }
+        if (stored >> key_bits != generation) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Lossy: when every probed slot holds a live entry the failure is not recorded
+inline void PerfectClearFinder::recordFailure(uint64_t node_key) {
+    size_t const mask = (size_t{1} << config.table_bits) - 1;
+    uint64_t const entry = generation << key_bits | node_key;
+    size_t slot = (node_key * 0x9E3779B97F4A7C15ULL) >> (64 - config.table_bits);
+    for (size_t probe = 0; probe < max_probes; probe++, slot = (slot + 1) & mask) {
+        uint64_t stored = table[slot].load(std::memory_order_relaxed);
+        while (stored >> key_bits != generation) {
+            if (table[slot].compare_exchange_weak(stored, entry, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        if (stored == entry) {
+            return;
+        }
+    }
+}
+
+// Calls f(move, child) for every placement of the current piece, or of the piece swapped in through hold, that stays
+// under the target height
+template <typename F>
+void PerfectClearFinder::forEachChild(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces,
+                                      bool hold_allowed, Scratch& s, F&& f) const {
+    int const ceiling = num_rows - node.lines;
+    for (bool use_hold : {false, true}) {
+        Tetromino piece = node.current.value();
+        std::optional<Tetromino> hold_piece = node.hold_piece;
+        size_t next_index = node.next_index;
+        if (use_hold) {
+            if (!hold_allowed || hold_piece == node.current) {
+                continue;
+            }
+            if (hold_piece.has_value()) {
+                piece = hold_piece.value();
+            } else if (next_index < num_known_pieces) {
+                piece = pieces[next_index++];
+            } else {
+                continue;
+            }
+            hold_piece = node.current;
+        }
+
+        // The generator's buffer is reused by the searches below, so the placements are copied out first. Different
+        // orientations of O, I, S and Z, and the T-spin variants of a placement, can cover the same cells.
+        s.board.rows = node.rows;
+        std::array<Placement, max_distinct_placements> distinct;
+        std::array<uint64_t, max_distinct_placements> covered;
+        size_t num_distinct = 0;
+        for (Placement const& placement : s.generator.generateBelow(s.board, piece, ceiling)) {
+            PieceMask const& mask = piece_masks[piece][placement.orientation];
+            if (placement.position.y + mask.min_y < ceiling) {
+                continue;
+            }
+            uint64_t cells = 0;
+            for (int dy = mask.min_y; dy <= mask.max_y; dy++) {
+                auto const row = static_cast<uint64_t>(
+                    (static_cast<uint32_t>(mask.rows[dy]) << (placement.position.x + wall_width)) >> wall_width);
+                cells |= row << (num_cols * (num_rows - 1 - placement.position.y - dy));
+            }
+            auto const end = covered.begin() + static_cast<std::ptrdiff_t>(num_distinct);
+            if (std::find(covered.begin(), end, cells) == end) {
+                covered[num_distinct] = cells;
+                distinct[num_distinct++] = placement;
+            }
+        }
+
+        for (size_t i = 0; i < num_distinct; i++) {
+            Placement const& placement = distinct[i];
+            Node child{.rows = node.rows,
+                       .hold_piece = hold_piece,
+                       .current = next_index < num_known_pieces ? std::optional<Tetromino>{pieces[next_index]}
+                                                                 : std::nullopt,
+                       .next_index = next_index + 1,
+                       .lines = node.lines};
+            placePiece(child.rows, piece, placement.position, placement.orientation);
+            child.lines -= static_cast<int>(clearFullRows(child.rows));
+            f(BotMove{.use_hold = use_hold, .placement = placement}, child);
+        }
+    }
+}
+
+inline auto PerfectClearFinder::search(Node const& node, std::array<Tetromino, num_known_pieces> const& pieces,
+                                       Scratch& s) -> bool {
+    if (node.lines == 0) {
+        return true;
+    }
+    size_t const available = (node.current.has_value() ? 1 : 0) + (node.hold_piece.has_value() ? 1 : 0) +
+                             (num_known_pieces - std::min(node.next_index, num_known_pieces));
+    auto const needed = static_cast<size_t>((node.lines * num_cols - filledCells(node.rows)) / cells_in_tetromino);
+    if (!node.current.has_value() || needed > available || s.path.size() + needed > config.max_pieces ||
+        !separatedPartsFillable(node.rows, node.lines)) {
+        return false;
+    }
+    uint64_t const node_key = key(node);
+    if (knownFailure(node_key)) {
+        return false;
+    }
+    s.nodes++;
+    bool found = false;
+    forEachChild(node, pieces, true, s, [&](BotMove const& move, Node const& child) {
+        if (found) {
+            return;
+        }
+        s.path.push_back(move);
+        found = search(child, pieces, s);
+        if (!found) {
+            s.path.pop_back();
+        }
+    });
+    if (!found) {
+        recordFailure(node_key);
+    }
+    return found;
+}
+
+inline auto PerfectClearFinder::find(Board const& board) -> std::optional<PerfectClear> {
+    if (!board.running) {
+        return {};
+    }
+    generation = (generation + 1) & ((uint64_t{1} << (64 - key_bits)) - 1);
+    if (generation == 0) {
+        for (size_t i = 0; i < (size_t{1} << config.table_bits); i++) {
+            table[i].store(0, std::memory_order_relaxed);
+        }
+        generation = 1;
+    }
+
+    std::array<Tetromino, num_known_pieces> const& pieces = board.curr_and_next_pieces;
+    int const cells = filledCells(board.rows);
+    int stack_height = 0;
+    while (stack_height < num_rows && board.rows[num_rows - 1 - stack_height] != empty_row) {
+        stack_height++;
+    }
+    for (int y = 0; y < num_rows - stack_height; y++) {
+        // Cells floating above an empty row after a line clear
+        if (board.rows[y] != empty_row) {
+            return {};
+        }
+    }
+
+    int const max_lines = std::min(config.max_lines, max_supported_lines);
+    for (int lines = std::max(stack_height, 1); lines <= max_lines; lines++) {
+        int const empty_cells = lines * num_cols - cells;
+        if (empty_cells % cells_in_tetromino != 0 ||
+            static_cast<size_t>(empty_cells / cells_in_tetromino) > config.max_pieces) {
+            continue;
+        }
+        Node const root{.rows = board.rows,
+                        .hold_piece = board.hold_piece,
+                        .current = board.active_piece.type,
+                        .next_index = 1,
+                        .lines = lines};
+
+        std::vector<std::pair<BotMove, Node>> first_moves;
+        forEachChild(root, pieces, !board.just_swapped_hold, *scratch[0],
+                     [&](BotMove const& move, Node const& child) { first_moves.emplace_back(move, child); });
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> best{first_moves.size()};
+        std::mutex result_mutex;
+        std::vector<BotMove> best_path;
+        auto job = [&](size_t worker) {
+            Scratch& s = *scratch[worker];
+            for (size_t k = next++; k < first_moves.size() && k < best.load(); k = next++) {
+                s.path.assign(1, first_moves[k].first);
+                if (!search(first_moves[k].second, pieces, s)) {
+                    continue;
+                }
+                std::lock_guard lock{result_mutex};
+                if (k < best.load()) {
+                    best = k;
+                    best_path = s.path;
+                }
+            }
+        };
+        pool.run(job);
+        for (auto& s : scratch) {
+            nodes_searched += s->nodes;
+            s->nodes = 0;
+        }
+        if (best.load() < first_moves.size()) {
+            return PerfectClear{.moves = std::move(best_path), .lines = lines};
+        }
+    }
+    return {};
+}
+
+} // namespace tetris
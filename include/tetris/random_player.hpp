@@ -0,0 +1,31 @@
+#pragma once
+
+#include "input.hpp"
+#include <cstdint>
+#include <random>
+
+namespace tetris {
+
+// Mashes keys: holds a direction for a while, taps rotations and hard drops at random
+struct RandomPlayer {
+    std::mt19937 g;
+    std::uniform_int_distribution<int> percent{0, 99};
+    int direction = 0;
+
+    explicit RandomPlayer(uint32_t seed) : g(seed) {}
+
+    auto next() -> InputState {
+        if (percent(g) < 10) {
+            direction = percent(g) % 3 - 1;
+        }
+        return InputState{.left_held = direction < 0,
+                          .right_held = direction > 0,
+                          .soft_drop_held = percent(g) < 20,
+                          .rotate_clockwise = percent(g) < 5,
+                          .rotate_anticlockwise = percent(g) < 5,
+                          .hard_drop = percent(g) < 3,
+                          .hold = percent(g) < 1};
+    }
+};
+
+} // namespace tetris
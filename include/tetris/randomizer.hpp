@@ -0,0 +1,89 @@
+#pragma once
+
+#include "pcg32.hpp"
+#include "tetris.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+
+namespace tetris {
+
+constexpr std::array<Tetromino, NUM_TETROMINOS> ordered_bag = {I, J, L, O, S, T, Z};
+
+enum class RandomizerKind : uint8_t {
+    // Fisher-Yates over PCG32, reproducible across platforms
+    Pcg32,
+    // The original randomizer: std::mt19937 and std::shuffle over two alternating bags. The sequence depends on the
+    // standard library, kept for comparison and for old replays.
+    Mt19937
+};
+
+// Writes out.size() / 7 shuffled bags
+inline void generateBags(rng::Pcg32& g, std::span<Tetromino> out) {
+    assert(out.size() % NUM_TETROMINOS == 0);
+    for (size_t start = 0; start < out.size(); start += NUM_TETROMINOS) {
+        Tetromino* bag = &out[start];
+        std::copy(ordered_bag.begin(), ordered_bag.end(), bag);
+        for (uint32_t i = NUM_TETROMINOS - 1; i > 0; i--) {
+            std::swap(bag[i], bag[g.bounded(i + 1)]);
+        }
+    }
+}
+
+struct Mt19937Bags {
+    std::mt19937 g;
+    std::array<std::array<Tetromino, NUM_TETROMINOS>, 2> bags = {ordered_bag, ordered_bag};
+    size_t next_bag = 0;
+
+    explicit Mt19937Bags(uint32_t seed) : g(seed) {}
+
+    void generate(std::span<Tetromino> out) {
+        assert(out.size() % NUM_TETROMINOS == 0);
+        for (size_t start = 0; start < out.size(); start += NUM_TETROMINOS) {
+            auto& bag = bags[next_bag];
+            std::shuffle(bag.begin(), bag.end(), g);
+            std::copy(bag.begin(), bag.end(), out.begin() + static_cast<std::ptrdiff_t>(start));
+            next_bag ^= 1U;
+        }
+    }
+};
+
+// 7-bag piece source. Boards built from the same seed and kind see the same piece stream. The mt19937 state (about
+// 5 KB) is only allocated when that kind is selected, a PCG32 board carries 16 bytes of generator state.
+struct BagRandomizer {
+    RandomizerKind kind;
+    rng::Pcg32 pcg;
+    std::unique_ptr<Mt19937Bags> mt19937;
+
+    BagRandomizer(uint32_t seed, RandomizerKind randomizer_kind)
+        : kind(randomizer_kind), pcg(seed),
+          mt19937(kind == RandomizerKind::Mt19937 ? std::make_unique<Mt19937Bags>(seed) : nullptr) {}
+    ~BagRandomizer() = default;
+    BagRandomizer(BagRandomizer const& other)
+        : kind(other.kind), pcg(other.pcg),
+          mt19937(other.mt19937 ? std::make_unique<Mt19937Bags>(*other.mt19937) : nullptr) {}
+    BagRandomizer(BagRandomizer&&) = default;
+    auto operator=(BagRandomizer const& other) -> BagRandomizer& {
+        if (this != &other) {
+            kind = other.kind;
+            pcg = other.pcg;
+            mt19937 = other.mt19937 ? std::make_unique<Mt19937Bags>(*other.mt19937) : nullptr;
+        }
+        return *this;
+    }
+    auto operator=(BagRandomizer&&) -> BagRandomizer& = default;
+
+    void generate(std::span<Tetromino> out) {
+        if (mt19937) {
+            mt19937->generate(out);
+        } else {
+            generateBags(pcg, out);
+        }
+    }
+};
+
+} // namespace tetris
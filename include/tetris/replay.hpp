@@ -0,0 +1,206 @@
+#pragma once
+
+#include "board.hpp"
+#include "input.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Replay file layout (integers are little-endian, varints are LEB128):
+//
+//   "TTRP" | version u8 | seed u32 | randomizer u8 | final score varint | lines cleared varint | frame count varint |
+//   entries...
+//
+// The version is bumped whenever a change to the simulation would alter the outcome of recorded games. Files from
+// other versions are rejected rather than reported as invalid.
+//
+// An entry is varint((microseconds since the previous entry << 1) | is_event). An input event is followed by a byte
+// (key << 1 | pressed), a frame without the flag is a call to Board::update with the events queued so far. Timestamps
+// are quantised to whole microseconds before they reach the board, so replaying the stream reproduces the game
+// exactly.
+namespace tetris {
+
+constexpr std::array<uint8_t, 4> replay_magic = {'T', 'T', 'R', 'P'};
+constexpr uint8_t replay_version = 4;
+
+inline auto toSeconds(uint64_t microseconds) -> double { return static_cast<double>(microseconds) * 1e-6; }
+
+inline auto toMicroseconds(double seconds) -> uint64_t { return static_cast<uint64_t>(std::llround(seconds * 1e6)); }
+
+inline auto packEvent(InputEvent const& event) -> uint8_t {
+    return static_cast<uint8_t>(static_cast<unsigned>(event.key) << 1U | static_cast<unsigned>(event.pressed));
+}
+
+inline void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline auto readVarint(std::span<uint8_t const> in, size_t& pos) -> std::optional<uint64_t> {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t byte = in[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    return {};
+}
+
+struct Replay {
+    uint32_t seed = 0;
+    RandomizerKind randomizer = RandomizerKind::Pcg32;
+    uint64_t final_score = 0;
+    uint64_t lines_cleared = 0;
+    uint64_t num_frames = 0;
+    std::vector<uint8_t> frames;
+};
+
+struct ReplayRecorder {
+    Replay replay;
+    uint64_t last_time_us = 0;
+
+    explicit ReplayRecorder(uint32_t seed, RandomizerKind randomizer = RandomizerKind::Pcg32) {
+        replay.seed = seed;
+        replay.randomizer = randomizer;
+    }
+
+    // Records the events Board::update is about to consume, quantising their times in place, and the step itself.
+    // Returns the quantised step time that has to be passed on to Board::update.
+    auto record(uint64_t time_us, InputEventQueue& events) -> double {
+        for (size_t i = 0; i < events.size; i++) {
+            InputEvent& event = events[i];
+            uint64_t const event_us = std::max(toMicroseconds(event.time), last_time_us);
+            if (event_us > time_us) {
+                break;
+            }
+            writeVarint(replay.frames, (event_us - last_time_us) << 1 | 1U);
+            replay.frames.push_back(packEvent(event));
+            event.time = toSeconds(event_us);
+            last_time_us = event_us;
+        }
+        writeVarint(replay.frames, (time_us - last_time_us) << 1);
+        last_time_us = time_us;
+        replay.num_frames++;
+        return toSeconds(time_us);
+    }
+
+    void finish(Board const& board) {
+        replay.final_score = static_cast<uint64_t>(board.score_state.current_score);
+        replay.lines_cleared = board.total_lines_cleared;
+    }
+};
+
+inline auto serializeReplay(Replay const& replay) -> std::vector<uint8_t> {
+    std::vector<uint8_t> out(replay_magic.begin(), replay_magic.end());
+    out.push_back(replay_version);
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(replay.seed >> (8 * i)));
+    }
+    out.push_back(static_cast<uint8_t>(replay.randomizer));
+    writeVarint(out, replay.final_score);
+    writeVarint(out, replay.lines_cleared);
+    writeVarint(out, replay.num_frames);
+    out.insert(out.end(), replay.frames.begin(), replay.frames.end());
+    return out;
+}
+
+inline auto parseReplay(std::span<uint8_t const> in) -> std::optional<Replay> {
+    constexpr size_t seed_offset = replay_magic.size() + 1;
+    if (in.size() < seed_offset + 4 || !std::equal(replay_magic.begin(), replay_magic.end(), in.begin()) ||
+        in[replay_magic.size()] != replay_version) {
+        return {};
+    }
+    Replay replay{};
+    for (size_t i = 0; i < 4; i++) {
+        replay.seed |= static_cast<uint32_t>(in[seed_offset + i]) << (8 * i);
+    }
+    size_t pos = seed_offset + 4;
+    if (pos == in.size() || in[pos] > static_cast<uint8_t>(RandomizerKind::Mt19937)) {
+        return {};
+    }
+    replay.randomizer = static_cast<RandomizerKind>(in[pos++]);
+    auto final_score = readVarint(in, pos);
+    auto lines_cleared = readVarint(in, pos);
+    auto num_frames = readVarint(in, pos);
+    if (!final_score.has_value() || !lines_cleared.has_value() || !num_frames.has_value()) {
+        return {};
+    }
+    replay.final_score = final_score.value();
+    replay.lines_cleared = lines_cleared.value();
+    replay.num_frames = num_frames.value();
+    replay.frames.assign(in.begin() + static_cast<std::ptrdiff_t>(pos), in.end());
+    return replay;
+}
+
+inline auto writeReplayFile(std::string const& path, Replay const& replay) -> bool {
+    std::vector<uint8_t> bytes = serializeReplay(replay);
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return file.good();
+}
+
+inline auto readReplayFile(std::string const& path) -> std::optional<Replay> {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        return {};
+    }
+    std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    return parseReplay(bytes);
+}
+
+// Re-simulates the replay from its seed. Returns nothing if the frame stream is malformed.
+inline auto simulateReplay(Replay const& replay) -> std::optional<Board> {
+    std::optional<Board> board{std::in_place, replay.seed, replay.randomizer};
+    InputEventQueue events;
+    uint64_t time_us = 0;
+    uint64_t frames = 0;
+    size_t pos = 0;
+    while (pos < replay.frames.size()) {
+        std::optional<uint64_t> delta = readVarint(replay.frames, pos);
+        if (!delta.has_value()) {
+            return {};
+        }
+        time_us += delta.value() >> 1;
+        if ((delta.value() & 1U) == 0) {
+            board->update(toSeconds(time_us), events);
+            frames++;
+            continue;
+        }
+        if (pos >= replay.frames.size()) {
+            return {};
+        }
+        uint8_t const bits = replay.frames[pos++];
+        if (bits >> 1U >= static_cast<uint8_t>(Key::NumKeys)) {
+            return {};
+        }
+        if (!events.push(InputEvent{
+                .time = toSeconds(time_us), .key = static_cast<Key>(bits >> 1U), .pressed = (bits & 1U) != 0})) {
+            return {};
+        }
+    }
+    if (frames != replay.num_frames || !events.empty()) {
+        return {};
+    }
+    return board;
+}
+
+inline auto verifyReplay(Replay const& replay) -> bool {
+    std::optional<Board> board = simulateReplay(replay);
+    return board.has_value() && static_cast<uint64_t>(board->score_state.current_score) == replay.final_score &&
+           board->total_lines_cleared == replay.lines_cleared;
+}
+
+} // namespace tetris
@@ -1,7 +1,10 @@
+#pragma once
+
+#include <array>
 #include <cassert>
-#include <iostream>
-#include <map>
+#include <cstddef>
 #include <optional>
+#include <ostream>
 
 namespace tetris {
 
@@ -16,16 +19,25 @@ enum class BaseActionScore {
     TSpinSingle,
     MiniTSpinDouble,
     TSpinDouble,
-    TSpinTriple
+    TSpinTriple,
+    NumBaseActionScores
 };
 
-const auto action_to_score =
-    std::map<BaseActionScore, int>{{BaseActionScore::Single, 100},          {BaseActionScore::Double, 300},
-                                   {BaseActionScore::Triple, 500},          {BaseActionScore::Tetris, 800},
-                                   {BaseActionScore::MiniTSpinZero, 100},   {BaseActionScore::TSpinZero, 400},
-                                   {BaseActionScore::MiniTSpinSingle, 200}, {BaseActionScore::TSpinSingle, 800},
-                                   {BaseActionScore::MiniTSpinDouble, 400}, {BaseActionScore::TSpinDouble, 1200},
-                                   {BaseActionScore::TSpinTriple, 1600}};
+// Indexed by BaseActionScore
+constexpr std::array<int, static_cast<size_t>(BaseActionScore::NumBaseActionScores)> action_to_score = {
+    100, 300, 500, 800, 100, 400, 200, 800, 400, 1200, 1600};
+
+constexpr std::array<char const*, static_cast<size_t>(BaseActionScore::NumBaseActionScores)> action_names = {
+    "Single",        "Double",          "Triple",      "Tetris",          "MiniTSpinZero", "TSpinZero",
+    "MiniTSpinSingle", "TSpinSingle", "MiniTSpinDouble", "TSpinDouble",   "TSpinTriple"};
+
+// Indexed by BaseActionScore
+constexpr std::array<size_t, static_cast<size_t>(BaseActionScore::NumBaseActionScores)> action_lines = {
+    1, 2, 3, 4, 0, 0, 1, 1, 2, 2, 3};
+
+// Added to the action score when the lines cleared leave the board empty, indexed by lines cleared - 1
+constexpr std::array<int, 4> perfect_clear_bonus = {800, 1200, 1800, 2000};
+constexpr int b2b_tetris_perfect_clear_bonus = 3200;
 
 enum class TSpinType { NotTSpin, WallKick, NoWallKick };
 
@@ -59,6 +71,8 @@ inline auto toBaseActionScore(size_t lines_cleared, TSpinType t_spin_type) -> st
             return BaseActionScore::TSpinSingle;
         case 2:
             return BaseActionScore::TSpinDouble;
+        case 3:
+            return BaseActionScore::TSpinTriple;
         default:
             break;
         }
@@ -80,69 +94,93 @@ inline auto toBaseActionScore(size_t lines_cleared, TSpinType t_spin_type) -> st
     return {};
 }
 
-// TODO: perfect clear scoring
+struct ScoreEvent {
+    BaseActionScore base_action_score;
+    bool b2b;
+    int combo_count;
+    bool perfect_clear;
+    int points;
+};
+
+inline void printScoreEvent(std::ostream& out, ScoreEvent const& event) {
+    if (event.b2b) {
+        out << "B2B ";
+    }
+    out << action_names[static_cast<size_t>(event.base_action_score)] << '\n';
+    if (event.perfect_clear) {
+        out << "Perfect Clear" << '\n';
+    }
+    if (event.combo_count > 0) {
+        out << "combo x" << event.combo_count << '\n';
+    }
+}
+
+// Fixed-capacity queue of score events for whoever wants to display them. Pushing never blocks or allocates: when the
+// consumer falls behind the oldest events are overwritten and counted in `dropped`.
+struct ScoreEventQueue {
+    static constexpr size_t capacity = 16;
+    std::array<ScoreEvent, capacity> events{};
+    size_t head = 0;
+    size_t size = 0;
+    size_t dropped = 0;
+
+    void push(ScoreEvent const& event) {
+        if (size == capacity) {
+            head = (head + 1) % capacity;
+            size--;
+            dropped++;
+        }
+        events[(head + size) % capacity] = event;
+        size++;
+    }
+
+    auto pop() -> std::optional<ScoreEvent> {
+        if (size == 0) {
+            return {};
+        }
+        ScoreEvent event = events[head];
+        head = (head + 1) % capacity;
+        size--;
+        return event;
+    }
+};
+
+// Guideline scoring. A perfect clear adds its bonus on top of the action, back-to-back only upgrades a tetris perfect
+// clear and does not multiply the bonus.
 struct ScoreState {
     int current_score = 0;
     bool prev_b2b = false;
     bool curr_b2b = false;
     int combo_count = -1;
 
-    static void printScoreType(bool b2b, BaseActionScore base_action_score, int combo_count) {
-        if (b2b) {
-            std::cout << "B2B ";
-        }
-        switch (base_action_score) {
-        case BaseActionScore::Single:
-            std::cout << "Single" << std::endl;
-            break;
-        case BaseActionScore::Double:
-            std::cout << "Double" << std::endl;
-            break;
-        case BaseActionScore::Triple:
-            std::cout << "Triple" << std::endl;
-            break;
-        case BaseActionScore::Tetris:
-            std::cout << "Tetris" << std::endl;
-            break;
-        case BaseActionScore::MiniTSpinZero:
-            std::cout << "MiniTSpinZero" << std::endl;
-            break;
-        case BaseActionScore::TSpinZero:
-            std::cout << "TSpinZero" << std::endl;
-            break;
-        case BaseActionScore::MiniTSpinSingle:
-            std::cout << "MiniTSpinSingle" << std::endl;
-            break;
-        case BaseActionScore::TSpinSingle:
-            std::cout << "TSpinSingle" << std::endl;
-            break;
-        case BaseActionScore::MiniTSpinDouble:
-            std::cout << "MiniTSpinDouble" << std::endl;
-            break;
-        case BaseActionScore::TSpinDouble:
-            std::cout << "TSpinDouble" << std::endl;
-            break;
-        case BaseActionScore::TSpinTriple:
-            std::cout << "TSpinTriple" << std::endl;
-            break;
-        }
-        if (combo_count > 0) {
-            std::cout << "combo x" << combo_count << std::endl;
-        }
-    }
-
-    void score(BaseActionScore base_action_score, int level, int soft_drop, int hard_drop) {
+    auto score(BaseActionScore base_action_score, int level, int soft_drop, int hard_drop, bool perfect_clear = false)
+        -> ScoreEvent {
+        int const score_before = current_score;
         current_score += soft_drop + hard_drop * 2;
         combo_count++;
         int combo_score = combo_count > 0 ? 50 * combo_count * (level + 1) : 0;
-        int curr_action_score = action_to_score.at(base_action_score) * (level + 1) + combo_score;
+        int curr_action_score = action_to_score[static_cast<size_t>(base_action_score)] * (level + 1) + combo_score;
         curr_b2b = isDifficult(base_action_score);
-        printScoreType(prev_b2b && curr_b2b, base_action_score, combo_count);
-        current_score += (prev_b2b && curr_b2b) ? curr_action_score * 3 / 2 : curr_action_score;
+        bool b2b = prev_b2b && curr_b2b;
+        current_score += b2b ? curr_action_score * 3 / 2 : curr_action_score;
         prev_b2b = curr_b2b;
+        size_t const lines = action_lines[static_cast<size_t>(base_action_score)];
+        perfect_clear = perfect_clear && lines > 0;
+        if (perfect_clear) {
+            int bonus = b2b && base_action_score == BaseActionScore::Tetris ? b2b_tetris_perfect_clear_bonus
+                                                                            : perfect_clear_bonus[lines - 1];
+            current_score += bonus * (level + 1);
+        }
+        return ScoreEvent{.base_action_score = base_action_score,
+                          .b2b = b2b,
+                          .combo_count = combo_count,
+                          .perfect_clear = perfect_clear,
+                          .points = current_score - score_before};
     }
 
     void resetCombo() { combo_count = -1; }
+
+    auto operator==(ScoreState const&) const -> bool = default;
 };
 
 } // namespace tetris
\ No newline at end of file
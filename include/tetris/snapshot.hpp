@@ -0,0 +1,179 @@
+#pragma once
+
+#include "board.hpp"
+#include "input.hpp"
+#include "pcg32.hpp"
+#include "randomizer.hpp"
+#include "score.hpp"
+#include "tetris.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/vector_int2.hpp>
+#include <optional>
+#include <vector>
+
+namespace tetris {
+
+// The whole simulation state of a board in a fixed-size, trivially copyable block, so saving and loading are plain
+// copies. Display state is left out: loading marks every row dirty and leaves the score event queue alone. The mt19937
+// generator does not fit either, BasicSnapshotRing keeps it alongside.
+template <typename R> struct BasicBoardSnapshot {
+    using Board = BasicBoard<R>;
+
+    decltype(Board::state) state;
+    typename R::Rows rows;
+    decltype(Board::column_heights) column_heights;
+    decltype(Board::bag_buffer) bag_buffer;
+    decltype(Board::curr_and_next_pieces) curr_and_next_pieces;
+    size_t bag_index;
+    std::optional<Tetromino> hold_piece;
+    Tetromino active_type;
+    Orientation active_orientation;
+    ivec2 active_position;
+    bool just_swapped_hold;
+    bool lock_delay;
+    bool running;
+    bool left_held;
+    bool right_held;
+    bool soft_drop_held;
+    int slide_direction;
+    TSpinType last_move;
+    InputState last_input;
+    int level;
+    size_t current_level_lines_cleared;
+    size_t total_lines_cleared;
+    size_t pieces_locked;
+    double current_time;
+    double last_update_time;
+    double gravity_rows;
+    double lock_delay_start_time;
+    double tick_rate;
+    double next_slide_time;
+    ScoreState score_state;
+    rng::Pcg32 pcg;
+
+    void save(Board const& board);
+    void load(Board& board) const;
+
+    auto operator==(BasicBoardSnapshot const&) const -> bool = default;
+};
+
+using BoardSnapshot = BasicBoardSnapshot<StandardRules>;
+
+template <typename R> void BasicBoardSnapshot<R>::save(Board const& board) {
+    state = board.state;
+    rows = board.rows;
+    column_heights = board.column_heights;
+    bag_buffer = board.bag_buffer;
+    curr_and_next_pieces = board.curr_and_next_pieces;
+    bag_index = board.bag_index;
+    hold_piece = board.hold_piece;
+    active_type = board.active_piece.type;
+    active_orientation = board.active_piece.orientation;
+    active_position = board.active_piece.position;
+    just_swapped_hold = board.just_swapped_hold;
+    lock_delay = board.lock_delay;
+    running = board.running;
+    left_held = board.left_held;
+    right_held = board.right_held;
+    soft_drop_held = board.soft_drop_held;
+    slide_direction = board.slide_direction;
+    last_move = board.last_move;
+    last_input = board.last_input;
+    level = board.level;
+    current_level_lines_cleared = board.current_level_lines_cleared;
+    total_lines_cleared = board.total_lines_cleared;
+    pieces_locked = board.pieces_locked;
+    current_time = board.current_time;
+    last_update_time = board.last_update_time;
+    gravity_rows = board.gravity_rows;
+    lock_delay_start_time = board.lock_delay_start_time;
+    tick_rate = board.tick_rate;
+    next_slide_time = board.next_slide_time;
+    score_state = board.score_state;
+    pcg = board.randomizer.pcg;
+}
+
+template <typename R> void BasicBoardSnapshot<R>::load(Board& board) const {
+    board.state = state;
+    board.rows = rows;
+    board.column_heights = column_heights;
+    board.dirty_rows = Board::all_rows_dirty;
+    board.bag_buffer = bag_buffer;
+    board.curr_and_next_pieces = curr_and_next_pieces;
+    board.bag_index = bag_index;
+    board.hold_piece = hold_piece;
+    board.active_piece.type = active_type;
+    board.active_piece.orientation = active_orientation;
+    board.active_piece.position = active_position;
+    board.just_swapped_hold = just_swapped_hold;
+    board.lock_delay = lock_delay;
+    board.running = running;
+    board.left_held = left_held;
+    board.right_held = right_held;
+    board.soft_drop_held = soft_drop_held;
+    board.slide_direction = slide_direction;
+    board.last_move = last_move;
+    board.last_input = last_input;
+    board.level = level;
+    board.current_level_lines_cleared = current_level_lines_cleared;
+    board.total_lines_cleared = total_lines_cleared;
+    board.pieces_locked = pieces_locked;
+    board.current_time = current_time;
+    board.last_update_time = last_update_time;
+    board.gravity_rows = gravity_rows;
+    board.lock_delay_start_time = lock_delay_start_time;
+    board.tick_rate = tick_rate;
+    board.next_slide_time = next_slide_time;
+    board.score_state = score_state;
+    board.randomizer.pcg = pcg;
+    board.updateGhostPiece();
+}
+
+// The last Capacity snapshots of a board, allocated up front, for rewind and rollback. Saving and rewinding copy one
+// snapshot and never allocate, except that the first save of a board on the mt19937 randomizer allocates a generator
+// copy per slot. All saves must come from the same board, or boards with the same randomizer kind.
+template <typename R, size_t Capacity> struct BasicSnapshotRing {
+    std::array<BasicBoardSnapshot<R>, Capacity> snapshots{};
+    std::vector<Mt19937Bags> mt19937_states;
+    // Saves not rewound over, of which the last Capacity are kept
+    size_t count = 0;
+
+    [[nodiscard]] auto size() const -> size_t { return std::min(count, Capacity); }
+
+    void save(BasicBoard<R> const& board) {
+        size_t const slot = count % Capacity;
+        snapshots[slot].save(board);
+        if (board.randomizer.mt19937) {
+            if (mt19937_states.empty()) {
+                mt19937_states.assign(Capacity, *board.randomizer.mt19937);
+            } else {
+                mt19937_states[slot] = *board.randomizer.mt19937;
+            }
+        }
+        count++;
+    }
+
+    // Loads the snapshot saved `age` saves ago, 0 being the newest, and forgets the newer ones so that saving carries
+    // on from it. Returns false and leaves the board alone when that snapshot is no longer kept.
+    auto rewind(BasicBoard<R>& board, size_t age) -> bool {
+        if (age >= size()) {
+            return false;
+        }
+        count -= age;
+        size_t const slot = (count - 1) % Capacity;
+        snapshots[slot].load(board);
+        if (board.randomizer.mt19937) {
+            *board.randomizer.mt19937 = mt19937_states[slot];
+        }
+        return true;
+    }
+
+    void clear() { count = 0; }
+};
+
+template <size_t Capacity> using SnapshotRing = BasicSnapshotRing<StandardRules, Capacity>;
+
+} // namespace tetris
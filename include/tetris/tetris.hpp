@@ -1,42 +1,19 @@
 #pragma once
 
-#include "raylib.h"
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <glm/ext/vector_int2.hpp>
+#include <type_traits>
+#include <utility>
 
 using namespace glm;
 
 namespace tetris {
 
-constexpr int cell_size = 30;
 constexpr int num_cols = 10;
 constexpr int num_rows = 22;
-constexpr float offset = 10;
-
-constexpr float hold_width = 130;
-constexpr float next_piece_width = 130;
-constexpr int medium_piece_size = 23;
-constexpr int tiny_piece_size = 17;
-constexpr int top_margin = 77;
-constexpr glm::ivec2 hold_position{hold_width / 2 - 1.5 * medium_piece_size + offset / 2, top_margin};
-constexpr int screen_width = 2 * tetris::offset + tetris::cell_size * tetris::num_cols + hold_width + next_piece_width;
-constexpr int screen_height = 2 * tetris::offset + tetris::cell_size * (tetris::num_rows - 2);
-constexpr glm::ivec2 first_next_position{hold_width + 2 * offset + tetris::cell_size * tetris::num_cols +
-                                             next_piece_width / 2 - 1.5 * medium_piece_size - offset / 2,
-                                         top_margin};
-constexpr glm::ivec2 next_position{hold_width + 2 * offset + tetris::cell_size * tetris::num_cols +
-                                       next_piece_width / 2 - 1.5 * tiny_piece_size - offset / 2,
-                                   top_margin + 7};
-constexpr int next_position_spacing = 60;
-
-constexpr Color red = {255, 0, 0, 255};
-constexpr Color orange = {255, 135, 0, 255};
-constexpr Color yellow = {255, 255, 0, 255};
-constexpr Color cyan = {10, 239, 255, 255};
-constexpr Color blue = {88, 10, 255, 255};
-constexpr Color green = {161, 255, 10, 255};
-constexpr Color purple = {190, 10, 255, 255};
 
 constexpr int cells_in_tetromino = 4;
 constexpr int num_wall_tests = 5;
@@ -68,6 +45,9 @@ constexpr auto levelDownTickRates() -> std::array<double, num_levels> {
 }
 constexpr std::array<double, num_levels> level_down_tick_rates = levelDownTickRates();
 
+// Seconds per row at which gravity becomes instant: 20 rows per frame at 60 Hz
+constexpr double twenty_g_tick_rate = 1.0 / (20 * 60);
+
 constexpr int num_next_pieces = 6;
 
 enum Orientation : size_t { UP = 0, RIGHT, DOWN, LEFT, NUM_ORIENTATIONS };
@@ -85,88 +65,310 @@ inline Orientation operator--(const Orientation& o, int) {
     return out;
 }
 
+enum Tetromino : uint8_t { I = 0, J, L, O, S, T, Z, NUM_TETROMINOS };
+
+// Cell type of garbage rows in Board::state. Not a piece, never indexes piece_attributes.
+constexpr Tetromino garbage_cell = NUM_TETROMINOS;
+
 using PieceStates = std::array<std::array<ivec2, cells_in_tetromino>, Orientation::NUM_ORIENTATIONS>;
+using TetrominoStates = std::array<PieceStates, NUM_TETROMINOS>;
+
+// Format is orientation -> rotation(anti-clockwise=0, clockwise=1) -> (x, y) offset, with y pointing up
+template <size_t N> using KickTable = std::array<std::array<std::array<ivec2, N>, 2>, Orientation::NUM_ORIENTATIONS>;
+using WallTests = KickTable<num_wall_tests>;
+
+// Plain offset the tables below are generated from, converted to ivec2 once complete
+struct Cell {
+    int x;
+    int y;
+};
+
+template <size_t N> constexpr auto toVectors(std::array<Cell, N> const& cells) -> std::array<ivec2, N> {
+    return [&cells]<size_t... k>(std::index_sequence<k...>) {
+        return std::array<ivec2, N>{ivec2{cells[k].x, cells[k].y}...};
+    }(std::make_index_sequence<N>{});
+}
+
+using CellSet = std::array<Cell, cells_in_tetromino>;
+using CellStates = std::array<CellSet, Orientation::NUM_ORIENTATIONS>;
+
+// Spawn orientation of each piece in the top-left corner of its rotation box, y pointing down
+constexpr std::array<CellSet, NUM_TETROMINOS> spawn_cells = {{
+    {{{0, 1}, {1, 1}, {2, 1}, {3, 1}}},
+    {{{0, 0}, {0, 1}, {1, 1}, {2, 1}}},
+    {{{2, 0}, {0, 1}, {1, 1}, {2, 1}}},
+    {{{0, 0}, {1, 0}, {0, 1}, {1, 1}}},
+    {{{1, 0}, {2, 0}, {0, 1}, {1, 1}}},
+    {{{1, 0}, {0, 1}, {1, 1}, {2, 1}}},
+    {{{0, 0}, {1, 0}, {1, 1}, {2, 1}}},
+}};
+constexpr std::array<int, NUM_TETROMINOS> box_sizes = {4, 3, 3, 2, 3, 3, 3};
+
+// Top row first, left to right within a row
+constexpr auto sortedCells(CellSet cells) -> CellSet {
+    std::sort(cells.begin(), cells.end(), [](Cell a, Cell b) { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+    return cells;
+}
+
+// Clockwise quarter turns about the centre of the box
+constexpr auto boxRotations(CellSet cells, int box) -> CellStates {
+    CellStates states{};
+    for (auto& state : states) {
+        state = sortedCells(cells);
+        for (Cell& cell : cells) {
+            cell = Cell{box - 1 - cell.y, cell.x};
+        }
+    }
+    return states;
+}
+
+constexpr auto bottomAligned(CellSet cells, int box) -> CellSet {
+    int lowest = 0;
+    for (Cell cell : cells) {
+        lowest = std::max(lowest, cell.y);
+    }
+    for (Cell& cell : cells) {
+        cell.y += box - 1 - lowest;
+    }
+    return cells;
+}
+
+template <typename F> constexpr auto tetrominoStates(F states_of) -> TetrominoStates {
+    auto piece_states = [](CellStates const& cells) {
+        return PieceStates{toVectors(cells[0]), toVectors(cells[1]), toVectors(cells[2]), toVectors(cells[3])};
+    };
+    return [&]<size_t... t>(std::index_sequence<t...>) {
+        return TetrominoStates{piece_states(states_of(static_cast<Tetromino>(t)))...};
+    }(std::make_index_sequence<NUM_TETROMINOS>{});
+}
+
+template <size_t N> using CellKicks = std::array<std::array<std::array<Cell, N>, 2>, Orientation::NUM_ORIENTATIONS>;
+
+template <size_t N> constexpr auto toKickTable(CellKicks<N> const& kicks) -> KickTable<N> {
+    return [&kicks]<size_t... o>(std::index_sequence<o...>) {
+        return KickTable<N>{{{{toVectors(kicks[o][0]), toVectors(kicks[o][1])}}...}};
+    }(std::make_index_sequence<Orientation::NUM_ORIENTATIONS>{});
+}
+
+// Kicks from the SRS offset formulation: each orientation has an offset per test and a rotation tests the difference
+// between the offsets of its source and target orientations. The first pair of offsets moves the true rotation onto the
+// box rotation used by the piece states, so it is subtracted from every test.
+template <size_t N>
+constexpr auto kicksFromOffsets(std::array<std::array<Cell, N>, Orientation::NUM_ORIENTATIONS> const& offsets)
+    -> KickTable<N> {
+    CellKicks<N> kicks{};
+    for (size_t from = 0; from < Orientation::NUM_ORIENTATIONS; from++) {
+        for (size_t clockwise = 0; clockwise < 2; clockwise++) {
+            size_t const to = (from + (clockwise == 1 ? 1 : Orientation::NUM_ORIENTATIONS - 1)) %
+                              Orientation::NUM_ORIENTATIONS;
+            for (size_t k = 0; k < N; k++) {
+                kicks[from][clockwise][k] = Cell{
+                    offsets[from][k].x - offsets[to][k].x - (offsets[from][0].x - offsets[to][0].x),
+                    offsets[from][k].y - offsets[to][k].y - (offsets[from][0].y - offsets[to][0].y)};
+            }
+        }
+    }
+    return toKickTable(kicks);
+}
+
+// Anti-clockwise kicks as the left-right mirror image of the clockwise ones, for rules that treat both directions alike
+template <size_t N>
+constexpr auto mirroredKicks(std::array<std::array<Cell, N>, Orientation::NUM_ORIENTATIONS> const& clockwise)
+    -> KickTable<N> {
+    CellKicks<N> kicks{};
+    for (size_t from = 0; from < Orientation::NUM_ORIENTATIONS; from++) {
+        size_t const mirror = (Orientation::NUM_ORIENTATIONS - from) % Orientation::NUM_ORIENTATIONS;
+        for (size_t k = 0; k < N; k++) {
+            kicks[from][1][k] = clockwise[from][k];
+            kicks[from][0][k] = Cell{-clockwise[mirror][k].x, clockwise[mirror][k].y};
+        }
+    }
+    return toKickTable(kicks);
+}
+
+template <size_t N> constexpr auto uniformKicks(std::array<Cell, N> const& tests) -> KickTable<N> {
+    CellKicks<N> kicks{};
+    for (auto& directions : kicks) {
+        directions = {tests, tests};
+    }
+    return toKickTable(kicks);
+}
+
+// Offset data from https://harddrop.com/wiki/SRS
+constexpr std::array<std::array<Cell, num_wall_tests>, Orientation::NUM_ORIENTATIONS> srs_offsets_not_i{{
+    {{{0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}}},
+    {{{0, 0}, {+1, 0}, {+1, -1}, {0, +2}, {+1, +2}}},
+    {{{0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}}},
+    {{{0, 0}, {-1, 0}, {-1, -1}, {0, +2}, {-1, +2}}},
+}};
+
+constexpr std::array<std::array<Cell, num_wall_tests>, Orientation::NUM_ORIENTATIONS> srs_offsets_i{{
+    {{{0, 0}, {-1, 0}, {+2, 0}, {-1, 0}, {+2, 0}}},
+    {{{-1, 0}, {0, 0}, {0, 0}, {0, +1}, {0, -2}}},
+    {{{-1, +1}, {+1, +1}, {-2, +1}, {+1, 0}, {-2, 0}}},
+    {{{0, +1}, {0, +1}, {0, +1}, {0, -1}, {0, +2}}},
+}};
+
+// A rotation system provides the piece states, the number of kick tests and kicks(type), the tests for a piece type.
+// Srs is the Super Rotation System, the guideline rules.
+struct Srs {
+    static constexpr size_t num_kicks = num_wall_tests;
+    static constexpr TetrominoStates states =
+        tetrominoStates([](Tetromino t) { return boxRotations(spawn_cells[t], box_sizes[t]); });
+    static constexpr KickTable<num_kicks> kicks_i = kicksFromOffsets(srs_offsets_i);
+    static constexpr KickTable<num_kicks> kicks_not_i = kicksFromOffsets(srs_offsets_not_i);
+
+    static constexpr auto kicks(Tetromino type) -> KickTable<num_kicks> const& {
+        return type == I ? kicks_i : kicks_not_i;
+    }
+};
+
+// SRS with the I kicks made symmetric between the two rotation directions, as in SRS+
+struct SrsPlus {
+    static constexpr size_t num_kicks = num_wall_tests;
+    static constexpr TetrominoStates states = Srs::states;
+    static constexpr KickTable<num_kicks> kicks_i = mirroredKicks<num_kicks>({{
+        {{{0, 0}, {+1, 0}, {-2, 0}, {-2, -1}, {+1, +2}}},
+        {{{0, 0}, {-1, 0}, {+2, 0}, {-1, +2}, {+2, -1}}},
+        {{{0, 0}, {+2, 0}, {-1, 0}, {+2, +1}, {-1, -2}}},
+        {{{0, 0}, {+1, 0}, {-2, 0}, {+1, -2}, {-2, +1}}},
+    }});
+    static constexpr KickTable<num_kicks> kicks_not_i = Srs::kicks_not_i;
+
+    static constexpr auto kicks(Tetromino type) -> KickTable<num_kicks> const& {
+        return type == I ? kicks_i : kicks_not_i;
+    }
+};
+
+// Arika-style rotation: J, L and T spawn flat side up, the three-wide pieces rest on the bottom of their box in every
+// orientation, and I, S and Z have two orientations each
+constexpr auto arsStates(Tetromino t) -> CellStates {
+    CellStates const srs = boxRotations(spawn_cells[t], box_sizes[t]);
+    CellStates states{};
+    for (size_t o = 0; o < Orientation::NUM_ORIENTATIONS; o++) {
+        size_t from = o;
+        if (t == J || t == L || t == T) {
+            from = (o + 2) % Orientation::NUM_ORIENTATIONS;
+        } else if (t == I) {
+            from = o % 2;
+        } else if (t == S || t == Z) {
+            from = o % 2 == 0 ? Orientation::UP : (t == S ? Orientation::LEFT : Orientation::RIGHT);
+        }
+        states[o] = box_sizes[t] == 3 ? sortedCells(bottomAligned(srs[from], box_sizes[t])) : srs[from];
+    }
+    return states;
+}
+
+// Rotations try one column right, then one left. I never kicks, its table repeats the plain rotation.
+struct Ars {
+    static constexpr size_t num_kicks = 3;
+    static constexpr TetrominoStates states = tetrominoStates(arsStates);
+    static constexpr KickTable<num_kicks> kicks_i = uniformKicks<num_kicks>({{{0, 0}, {0, 0}, {0, 0}}});
+    static constexpr KickTable<num_kicks> kicks_not_i = uniformKicks<num_kicks>({{{0, 0}, {+1, 0}, {-1, 0}}});
+
+    static constexpr auto kicks(Tetromino type) -> KickTable<num_kicks> const& {
+        return type == I ? kicks_i : kicks_not_i;
+    }
+};
+
+struct PieceMask {
+    std::array<uint8_t, cells_in_tetromino> rows;
+    // Lowest relative y in each relative column, -1 where the piece has no cell
+    std::array<int, cells_in_tetromino> column_bottoms;
+    int min_x;
+    int max_x;
+    int min_y;
+    int max_y;
+};
+
+using PieceMasks = std::array<std::array<PieceMask, Orientation::NUM_ORIENTATIONS>, NUM_TETROMINOS>;
+
+// Row masks with the piece's relative x offsets as bits, shifted into place by (position.x + wall_width)
+constexpr auto pieceMasks(TetrominoStates const& states) -> PieceMasks {
+    PieceMasks masks{};
+    for (size_t t = 0; t < NUM_TETROMINOS; t++) {
+        for (size_t o = 0; o < Orientation::NUM_ORIENTATIONS; o++) {
+            PieceMask mask{.rows = {},
+                           .column_bottoms = {-1, -1, -1, -1},
+                           .min_x = cells_in_tetromino,
+                           .max_x = 0,
+                           .min_y = cells_in_tetromino,
+                           .max_y = 0};
+            for (ivec2 cell : states[t][o]) {
+                mask.rows[cell.y] |= static_cast<uint8_t>(1U << cell.x);
+                mask.column_bottoms[cell.x] = std::max(mask.column_bottoms[cell.x], cell.y);
+                mask.min_x = std::min(mask.min_x, cell.x);
+                mask.max_x = std::max(mask.max_x, cell.x);
+                mask.min_y = std::min(mask.min_y, cell.y);
+                mask.max_y = std::max(mask.max_y, cell.y);
+            }
+            masks[t][o] = mask;
+        }
+    }
+    return masks;
+}
+
+// Occupancy bitboard: one word per row, bit (wall_width + col) set when the cell is filled. The bits outside the
+// playfield are permanently set so that they act as walls for the collision test.
+constexpr int wall_width = 3;
+constexpr int floor_rows = cells_in_tetromino - 1;
+
+// Narrowest unsigned word that holds a row of the playfield and a wall on each side
+template <int Width>
+using RowFor = std::conditional_t<Width + 2 * wall_width <= 16, uint16_t,
+                                  std::conditional_t<Width + 2 * wall_width <= 32, uint32_t, uint64_t>>;
+
+// Everything about a board that is fixed at compile time: the playfield size, the row word that fits it and the
+// rotation system. A board instantiated with it only reads constexpr tables, so every combination gets its own hot
+// loops and nothing branches on the rule set at runtime. Pieces spawn centred, rounding left.
+template <int Width, int Height, typename RotationSystem> struct Rules {
+    static_assert(Width >= cells_in_tetromino && Width + 2 * wall_width <= 64, "Unsupported board width");
+    // Two hidden rows at the top, and Board keeps one dirty bit per row in 32 bits
+    static_assert(Height > 2 && Height < 32, "Unsupported board height");
+
+    static constexpr int num_cols = Width;
+    static constexpr int num_rows = Height;
+    using Row = RowFor<Width>;
+    using Rows = std::array<Row, Height + floor_rows>;
+    using Rotations = RotationSystem;
+
+    static constexpr Row full_row = static_cast<Row>(~Row{0});
+    static constexpr Row empty_row = static_cast<Row>(full_row & ~(((uint64_t{1} << Width) - 1) << wall_width));
+    static constexpr TetrominoStates states = RotationSystem::states;
+    static constexpr PieceMasks masks = pieceMasks(states);
+    static constexpr std::array<ivec2, NUM_TETROMINOS> spawn_positions =
+        []<size_t... t>(std::index_sequence<t...>) {
+            return std::array<ivec2, NUM_TETROMINOS>{ivec2{(Width - box_sizes[t]) / 2, 2}...};
+        }(std::make_index_sequence<NUM_TETROMINOS>{});
+
+    static constexpr auto cellBit(int col) -> Row { return static_cast<Row>(uint64_t{1} << (col + wall_width)); }
+};
+
+// The rules of the game as played, used by everything outside the board itself
+using StandardRules = Rules<num_cols, num_rows, Srs>;
+
+using Row = StandardRules::Row;
+using Rows = StandardRules::Rows;
+constexpr Row full_row = StandardRules::full_row;
+constexpr Row empty_row = StandardRules::empty_row;
+
+constexpr auto cellBit(int col) -> Row { return StandardRules::cellBit(col); }
 
 struct PieceAttributes {
     PieceStates states;
-    Color color;
     glm::ivec2 spawn_pos;
 };
 
-constexpr PieceAttributes i_attr{.states = {{{{{0, 1}, {1, 1}, {2, 1}, {3, 1}}},
-                                             {{{2, 0}, {2, 1}, {2, 2}, {2, 3}}},
-                                             {{{0, 2}, {1, 2}, {2, 2}, {3, 2}}},
-                                             {{{1, 0}, {1, 1}, {1, 2}, {1, 3}}}}},
-                                 .color = cyan,
-                                 .spawn_pos = {3, 2}};
-
-constexpr PieceAttributes j_attr{.states = {{{{{0, 0}, {0, 1}, {1, 1}, {2, 1}}},
-                                             {{{1, 0}, {2, 0}, {1, 1}, {1, 2}}},
-                                             {{{0, 1}, {1, 1}, {2, 1}, {2, 2}}},
-                                             {{{1, 0}, {1, 1}, {0, 2}, {1, 2}}}}},
-                                 .color = blue,
-                                 .spawn_pos = {3, 2}};
-
-constexpr PieceAttributes l_attr{.states = {{{{{2, 0}, {0, 1}, {1, 1}, {2, 1}}},
-                                             {{{1, 0}, {1, 1}, {1, 2}, {2, 2}}},
-                                             {{{0, 1}, {1, 1}, {2, 1}, {0, 2}}},
-                                             {{{0, 0}, {1, 0}, {1, 1}, {1, 2}}}}},
-                                 .color = orange,
-                                 .spawn_pos = {3, 2}};
-
-constexpr PieceAttributes o_attr{.states = {{{{{0, 0}, {0, 1}, {1, 0}, {1, 1}}},
-                                             {{{0, 0}, {0, 1}, {1, 0}, {1, 1}}},
-                                             {{{0, 0}, {0, 1}, {1, 0}, {1, 1}}},
-                                             {{{0, 0}, {0, 1}, {1, 0}, {1, 1}}}}},
-                                 .color = yellow,
-                                 .spawn_pos = {4, 2}};
-
-constexpr PieceAttributes s_attr{.states = {{{{{1, 0}, {2, 0}, {0, 1}, {1, 1}}},
-                                             {{{1, 0}, {1, 1}, {2, 1}, {2, 2}}},
-                                             {{{1, 1}, {2, 1}, {0, 2}, {1, 2}}},
-                                             {{{0, 0}, {0, 1}, {1, 1}, {1, 2}}}}},
-                                 .color = green,
-                                 .spawn_pos = {3, 2}};
-
-constexpr PieceAttributes t_attr{.states = {{{{{1, 0}, {0, 1}, {1, 1}, {2, 1}}},
-                                             {{{1, 0}, {1, 1}, {2, 1}, {1, 2}}},
-                                             {{{0, 1}, {1, 1}, {2, 1}, {1, 2}}},
-                                             {{{1, 0}, {0, 1}, {1, 1}, {1, 2}}}}},
-                                 .color = purple,
-                                 .spawn_pos = {3, 2}};
-
-constexpr PieceAttributes z_attr{.states = {{{{{0, 0}, {1, 0}, {1, 1}, {2, 1}}},
-                                             {{{2, 0}, {1, 1}, {2, 1}, {1, 2}}},
-                                             {{{0, 1}, {1, 1}, {1, 2}, {2, 2}}},
-                                             {{{1, 0}, {0, 1}, {1, 1}, {0, 2}}}}},
-                                 .color = red,
-                                 .spawn_pos = {3, 2}};
-
-enum Tetromino : size_t { I = 0, J, L, O, S, T, Z, NUM_TETROMINOS };
-
-constexpr std::array<PieceAttributes, NUM_TETROMINOS> piece_attributes = {
-    {i_attr, j_attr, l_attr, o_attr, s_attr, t_attr, z_attr}};
-
-using WallTests = std::array<std::array<std::array<ivec2, num_wall_tests>, 2>, Orientation::NUM_ORIENTATIONS>;
-
-// Wall kick data from https://harddrop.com/wiki/SRS
-// Format is orientation -> rotation(anti-clockwise=0, clockwise=1) -> (x, y) offset. y is negated in the dataset
-// because of differences coordinate system
-constexpr WallTests wall_kick_tests_not_i{{
-    {{{{{0, 0}, {+1, 0}, {+1, +1}, {0, -2}, {+1, -2}}}, {{{0, 0}, {-1, 0}, {-1, +1}, {0, -2}, {-1, -2}}}}},
-    {{{{{0, 0}, {+1, 0}, {+1, -1}, {0, +2}, {+1, +2}}}, {{{0, 0}, {+1, 0}, {+1, -1}, {0, +2}, {+1, +2}}}}},
-    {{{{{0, 0}, {-1, 0}, {-1, +1}, {0, -2}, {-1, -2}}}, {{{0, 0}, {+1, 0}, {+1, +1}, {0, -2}, {+1, -2}}}}},
-    {{{{{0, 0}, {-1, 0}, {-1, -1}, {0, +2}, {-1, +2}}}, {{{0, 0}, {-1, 0}, {-1, -1}, {0, +2}, {-1, +2}}}}},
-}};
+constexpr std::array<PieceAttributes, NUM_TETROMINOS> piece_attributes = []<size_t... t>(std::index_sequence<t...>) {
+    return std::array<PieceAttributes, NUM_TETROMINOS>{
+        PieceAttributes{.states = StandardRules::states[t], .spawn_pos = StandardRules::spawn_positions[t]}...};
+}(std::make_index_sequence<NUM_TETROMINOS>{});
 
-constexpr WallTests wall_kick_tests_i{{
-    {{{{{0, 0}, {-1, 0}, {+2, 0}, {-1, +2}, {+2, -1}}}, {{{0, 0}, {-2, 0}, {+1, 0}, {-2, -1}, {+1, +2}}}}},
-    {{{{{0, 0}, {+2, 0}, {-1, 0}, {+2, +1}, {-1, -2}}}, {{{0, 0}, {-1, 0}, {+2, 0}, {-1, +2}, {+2, -1}}}}},
-    {{{{{0, 0}, {+1, 0}, {-2, 0}, {+1, -2}, {-2, +1}}}, {{{0, 0}, {+2, 0}, {-1, 0}, {+2, +1}, {-1, -2}}}}},
-    {{{{{0, 0}, {-2, 0}, {+1, 0}, {-2, -1}, {+1, +2}}}, {{{0, 0}, {+1, 0}, {-2, 0}, {+1, -2}, {-2, +1}}}}},
-}};
+constexpr PieceMasks piece_masks = StandardRules::masks;
+
+constexpr WallTests wall_kick_tests_not_i = StandardRules::Rotations::kicks_not_i;
+constexpr WallTests wall_kick_tests_i = StandardRules::Rotations::kicks_i;
 
-enum class SlideState { Inactive, StartDelay, Slide };
 constexpr double slide_rate = 0.04;
 constexpr double slide_delay_period = 0.08;
 
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "board.hpp"
+#include "bot.hpp"
+#include "pcg32.hpp"
+#include "score.hpp"
+#include "tetris.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Headless battle royale: every player is a Board driven by the bot, line clears send garbage to a random opponent.
+namespace tetris {
+
+// Indexed by BaseActionScore
+constexpr std::array<int, static_cast<size_t>(BaseActionScore::NumBaseActionScores)> action_garbage = {
+    0, 1, 2, 4, 0, 0, 0, 2, 1, 4, 6};
+
+// Indexed by combo count, the last entry covers longer combos
+constexpr std::array<int, 12> combo_garbage = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 4, 5};
+
+inline auto garbageLines(ScoreEvent const& event) -> int {
+    int lines = action_garbage[static_cast<size_t>(event.base_action_score)];
+    if (event.b2b) {
+        lines++;
+    }
+    if (event.combo_count > 0) {
+        lines += combo_garbage[std::min<size_t>(event.combo_count, combo_garbage.size() - 1)];
+    }
+    return lines;
+}
+
+struct VersusConfig {
+    size_t players = 2;
+    size_t max_rounds = 2000;
+    // Most garbage rows inserted after a single lock, the rest stays pending
+    int garbage_cap = 8;
+    BotConfig bot{.depth = 1, .beam_width = 1, .threads = 1, .weights = {}};
+};
+
+struct VersusPlayer {
+    Board board;
+    // Target and hole selection, one PCG stream per player
+    rng::Pcg32 g;
+    int pending_garbage = 0;
+    size_t garbage_sent = 0;
+    size_t garbage_received = 0;
+    size_t eliminated_round = 0;
+};
+
+// Garbage sent during round r is added to slot (r + 1) % 2 of the target's inbox and taken at the start of its turn in
+// round r + 1. Rounds are separated by WorkerPool::run, so the outcome does not depend on which thread stepped whom.
+struct alignas(64) GarbageInbox {
+    std::array<std::atomic<int>, 2> lines{};
+};
+
+// One match. All players see the same piece stream, built from the match seed.
+struct VersusMatch {
+    VersusConfig config;
+    std::vector<VersusPlayer> players;
+    std::unique_ptr<GarbageInbox[]> inboxes;
+    // Players still in the game at the start of the current round, the only valid garbage targets
+    std::vector<size_t> alive;
+    size_t round = 0;
+    size_t boards_stepped = 0;
+
+    VersusMatch(VersusConfig const& versus_config, uint32_t seed)
+        : config(versus_config), inboxes(std::make_unique<GarbageInbox[]>(config.players)) {
+        players.reserve(config.players);
+        for (size_t i = 0; i < config.players; i++) {
+            players.push_back(VersusPlayer{.board = Board{seed}, .g = rng::Pcg32{seed, i}});
+            alive.push_back(i);
+        }
+    }
+
+    [[nodiscard]] auto finished() const -> bool { return alive.size() <= 1 || round >= config.max_rounds; }
+
+    // Plays one piece for player i. Called concurrently for different players within a round.
+    void stepPlayer(size_t i, Bot& bot);
+    // Runs after every player has been stepped
+    void endRound();
+    [[nodiscard]] auto winner() const -> std::optional<size_t>;
+};
+
+inline void VersusMatch::stepPlayer(size_t i, Bot& bot) {
+    VersusPlayer& player = players[i];
+    Board& board = player.board;
+    if (!board.running) {
+        return;
+    }
+    // Relaxed is enough: senders wrote this slot in the previous round, before the pool's barrier
+    int const incoming = inboxes[i].lines[round % 2].exchange(0, std::memory_order_relaxed);
+    player.pending_garbage += incoming;
+    player.garbage_received += static_cast<size_t>(incoming);
+
+    std::optional<BotMove> move = bot.think(board);
+    if (!move.has_value()) {
+        board.running = false;
+        return;
+    }
+    size_t const lines_before = board.total_lines_cleared;
+    Bot::play(board, move.value());
+
+    int attack = 0;
+    while (std::optional<ScoreEvent> event = board.score_events.pop()) {
+        attack += garbageLines(event.value());
+    }
+    // Outgoing attack cancels pending garbage first
+    int const cancelled = std::min(attack, player.pending_garbage);
+    attack -= cancelled;
+    player.pending_garbage -= cancelled;
+
+    if (board.total_lines_cleared == lines_before && player.pending_garbage > 0 && board.running) {
+        int const lines = std::min(player.pending_garbage, config.garbage_cap);
+        board.addGarbage(lines, static_cast<int>(player.g.bounded(num_cols)));
+        player.pending_garbage -= lines;
+    }
+
+    if (attack > 0 && alive.size() > 1) {
+        // Uniform over the other players alive at the start of the round
+        size_t target = alive[player.g.bounded(static_cast<uint32_t>(alive.size() - 1))];
+        if (target == i) {
+            target = alive.back();
+        }
+        inboxes[target].lines[(round + 1) % 2].fetch_add(attack, std::memory_order_relaxed);
+        player.garbage_sent += static_cast<size_t>(attack);
+    }
+}
+
+inline void VersusMatch::endRound() {
+    boards_stepped += alive.size();
+    round++;
+    std::erase_if(alive, [this](size_t i) {
+        if (players[i].board.running) {
+            return false;
+        }
+        players[i].eliminated_round = round;
+        return true;
+    });
+}
+
+inline auto VersusMatch::winner() const -> std::optional<size_t> {
+    if (alive.size() == 1) {
+        return alive.front();
+    }
+    return {};
+}
+
+// Steps a set of matches round by round, spreading the players of all matches over the pool. Each worker owns a bot.
+struct VersusRunner {
+    WorkerPool& pool;
+    std::vector<std::unique_ptr<Bot>> bots;
+
+    VersusRunner(WorkerPool& worker_pool, BotConfig const& bot_config) : pool(worker_pool) {
+        for (size_t i = 0; i < pool.size(); i++) {
+            bots.push_back(std::make_unique<Bot>(bot_config));
+        }
+    }
+
+    void run(std::vector<VersusMatch>& matches) {
+        std::vector<std::pair<size_t, size_t>> work;
+        std::atomic<size_t> next{0};
+        auto job = [&](size_t worker) {
+            Bot& bot = *bots[worker];
+            for (size_t k = next++; k < work.size(); k = next++) {
+                matches[work[k].first].stepPlayer(work[k].second, bot);
+            }
+        };
+        while (true) {
+            work.clear();
+            for (size_t m = 0; m < matches.size(); m++) {
+                if (!matches[m].finished()) {
+                    for (size_t i : matches[m].alive) {
+                        work.emplace_back(m, i);
+                    }
+                }
+            }
+            if (work.empty()) {
+                return;
+            }
+            next = 0;
+            pool.run(job);
+            for (auto& match : matches) {
+                if (!match.finished()) {
+                    match.endRound();
+                }
+            }
+        }
+    }
+};
+
+} // namespace tetris
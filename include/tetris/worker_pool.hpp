@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+// Fixed set of threads that all run the same job and then park until the next one. The calling thread takes part as
+// worker 0, so a pool of size 1 runs everything inline. run() does not allocate.
+struct WorkerPool {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    size_t generation = 0;
+    size_t pending = 0;
+    bool stopping = false;
+    void* job_context = nullptr;
+    void (*job)(void*, size_t) = nullptr;
+
+    explicit WorkerPool(size_t num_workers = std::max(1U, std::thread::hardware_concurrency())) {
+        for (size_t i = 1; i < num_workers; i++) {
+            threads.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool(WorkerPool&&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    WorkerPool& operator=(WorkerPool&&) = delete;
+    ~WorkerPool() {
+        {
+            std::lock_guard lock{mutex};
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    [[nodiscard]] auto size() const -> size_t { return threads.size() + 1; }
+
+    // Calls f(worker_index) once on every worker and returns when all of them are done
+    template <typename F> void run(F& f) {
+        {
+            std::lock_guard lock{mutex};
+            job_context = &f;
+            job = [](void* context, size_t worker) { (*static_cast<F*>(context))(worker); };
+            pending = threads.size();
+            generation++;
+        }
+        start_cv.notify_all();
+        f(0);
+        std::unique_lock lock{mutex};
+        done_cv.wait(lock, [this]() { return pending == 0; });
+    }
+
+    void workerLoop(size_t worker) {
+        size_t seen_generation = 0;
+        std::unique_lock lock{mutex};
+        while (true) {
+            start_cv.wait(lock, [&]() { return stopping || generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = generation;
+            lock.unlock();
+            job(job_context, worker);
+            lock.lock();
+            if (--pending == 0) {
+                done_cv.notify_one();
+            }
+        }
+    }
+};
+
+} // namespace tetris
@@ -0,0 +1,154 @@
+#pragma once
+
+// Scoped phase timers. Built with ENABLE_TRACING (the CMake option of the same name) every TRACE_SCOPE records its
+// name, start and duration into a ring buffer owned by the calling thread. TRACE_WRITE dumps all buffers as Chrome
+// trace event JSON (chrome://tracing, ui.perfetto.dev) and prints p50/p99/max per scope name. Without ENABLE_TRACING
+// the macros expand to nothing and this header declares nothing.
+#ifdef ENABLE_TRACING
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace trace {
+
+struct Event {
+    // Must point to storage that outlives the trace, in practice a string literal
+    char const* name;
+    int64_t start_ns;
+    int64_t duration_ns;
+};
+
+// Single writer: only the owning thread records. Once full, the oldest events are overwritten.
+struct ThreadBuffer {
+    static constexpr size_t capacity = size_t{1} << 16;
+    uint32_t thread_id;
+    std::array<Event, capacity> events;
+    size_t next = 0;
+
+    explicit ThreadBuffer(uint32_t id) : thread_id(id) {}
+
+    void record(Event const& event) {
+        events[next & (capacity - 1)] = event;
+        next++;
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+inline auto registry() -> Registry& {
+    static Registry instance;
+    return instance;
+}
+
+inline auto now() -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().epoch)
+        .count();
+}
+
+// Registered on the first scope a thread enters, kept until exit so the events of finished threads are still dumped
+inline auto threadBuffer() -> ThreadBuffer& {
+    thread_local ThreadBuffer* buffer = [] {
+        Registry& r = registry();
+        std::lock_guard lock{r.mutex};
+        auto id = static_cast<uint32_t>(r.buffers.size());
+        return r.buffers.emplace_back(std::make_unique<ThreadBuffer>(id)).get();
+    }();
+    return *buffer;
+}
+
+struct Scope {
+    char const* name;
+    int64_t start_ns;
+
+    explicit Scope(char const* scope_name) : name(scope_name), start_ns(now()) {}
+    ~Scope() { threadBuffer().record(Event{.name = name, .start_ns = start_ns, .duration_ns = now() - start_ns}); }
+    Scope(Scope const&) = delete;
+    Scope(Scope&&) = delete;
+    auto operator=(Scope const&) -> Scope& = delete;
+    auto operator=(Scope&&) -> Scope& = delete;
+};
+
+// Visits the retained events of every thread, oldest first. Not synchronised with the writers: call it once the traced
+// threads are idle or joined.
+template <typename F> void forEachEvent(F&& f) {
+    Registry& r = registry();
+    std::lock_guard lock{r.mutex};
+    for (auto const& buffer : r.buffers) {
+        size_t const first = buffer->next > ThreadBuffer::capacity ? buffer->next - ThreadBuffer::capacity : 0;
+        for (size_t i = first; i < buffer->next; i++) {
+            f(buffer->thread_id, buffer->events[i & (ThreadBuffer::capacity - 1)]);
+        }
+    }
+}
+
+// Scope names are identifiers and string literals without quotes or backslashes, so they are written unescaped
+inline void writeChromeTrace(std::ostream& out) {
+    out << "{\"traceEvents\": [";
+    bool first = true;
+    char line[256];
+    forEachEvent([&](uint32_t thread_id, Event const& event) {
+        std::snprintf(line, sizeof(line),
+                      "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}",
+                      first ? "" : ",", event.name, static_cast<double>(event.start_ns) / 1e3,
+                      static_cast<double>(event.duration_ns) / 1e3, thread_id);
+        out << line;
+        first = false;
+    });
+    out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+// Duration percentiles per scope name, nearest rank. A scope wrapped around the whole loop body gives frame times.
+inline void writeSummary(std::ostream& out) {
+    std::map<std::string_view, std::vector<int64_t>> durations;
+    forEachEvent(
+        [&](uint32_t /*thread_id*/, Event const& event) { durations[event.name].push_back(event.duration_ns); });
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-28s %8s %10s %10s %10s\n", "scope", "count", "p50 us", "p99 us", "max us");
+    out << line;
+    for (auto& [name, samples] : durations) {
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](size_t p) {
+            size_t const rank = (p * samples.size() + 99) / 100;
+            return static_cast<double>(samples[std::max<size_t>(rank, 1) - 1]) / 1e3;
+        };
+        std::snprintf(line, sizeof(line), "%-28.*s %8zu %10.3f %10.3f %10.3f\n", static_cast<int>(name.size()),
+                      name.data(), samples.size(), percentile(50), percentile(99),
+                      static_cast<double>(samples.back()) / 1e3);
+        out << line;
+    }
+}
+
+inline void write(char const* path) {
+    std::ofstream file{path};
+    writeChromeTrace(file);
+    std::cout << "trace written to " << path << "\n";
+    writeSummary(std::cout);
+}
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_WRITE(path) trace::write(path)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_WRITE(path)
+
+#endif
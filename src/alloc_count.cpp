@@ -0,0 +1,26 @@
+#include "alloc_count.hpp"
+#include <cstdlib>
+#include <new>
+
+// Global operator new and delete replaced with counting versions, linked into the executables that check a path does
+// not allocate. The nothrow forms call these by default. Over-aligned allocations keep the library's own functions and
+// are not counted.
+namespace {
+
+auto countedAlloc(std::size_t size) -> void* {
+    alloc_count::allocations.fetch_add(1, std::memory_order_relaxed);
+    alloc_count::bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+} // namespace
+
+auto operator new(std::size_t size) -> void* { return countedAlloc(size); }
+auto operator new[](std::size_t size) -> void* { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t /*size*/) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t /*size*/) noexcept { std::free(p); }
@@ -0,0 +1,166 @@
+#include "asset_bundle.hpp"
+#include "asset_bundle_raylib.hpp"
+#include "raylib.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Build step that decodes the game assets once, so the games map pixels and samples instead of decoding PNG and MP3 at
+// every start. See asset_bundle.hpp for the layout.
+//
+//   asset_pack <assets dir> <bundle>    packs every image and sound file in the directory
+//   asset_pack measure <assets dir> <bundle> [repetitions]    load time from the loose files and from the bundle,
+//                                                             exits non-zero if they don't hold the same data
+namespace {
+
+// Decoded contents of the asset files in `directory` by name, with the buffers their data points into
+struct DecodedAssets {
+    std::vector<assets::Asset> assets;
+    std::vector<std::vector<uint8_t>> buffers;
+};
+
+auto assetKind(std::filesystem::path const& path) -> std::optional<assets::AssetKind> {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".png" || extension == ".bmp" || extension == ".jpg" || extension == ".qoi") {
+        return assets::AssetKind::Image;
+    }
+    if (extension == ".mp3" || extension == ".wav" || extension == ".ogg" || extension == ".flac") {
+        return assets::AssetKind::Sound;
+    }
+    return {};
+}
+
+// The asset files in `directory` in name order, so a bundle only changes when its files do
+auto assetFiles(std::string const& directory) -> std::vector<std::filesystem::path> {
+    std::vector<std::filesystem::path> files;
+    for (auto const& entry : std::filesystem::directory_iterator{directory}) {
+        if (entry.is_regular_file() && assetKind(entry.path()).has_value()) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+auto decodeAssets(std::string const& directory) -> DecodedAssets {
+    DecodedAssets decoded;
+    for (auto const& path : assetFiles(directory)) {
+        assets::Asset asset;
+        asset.name = path.filename().string();
+        asset.kind = assetKind(path).value();
+        std::vector<uint8_t> buffer;
+        if (asset.kind == assets::AssetKind::Image) {
+            Image image = assets::decodeImage(path.string());
+            asset.params = {static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), 0, 0};
+            auto const* pixels = static_cast<uint8_t const*>(image.data);
+            buffer.assign(pixels, pixels + assets::dataSize(asset.kind, asset.params));
+            UnloadImage(image);
+        } else {
+            Wave wave = LoadWave(path.string().c_str());
+            asset.params = {wave.frameCount, wave.sampleRate, wave.sampleSize, wave.channels};
+            auto const* samples = static_cast<uint8_t const*>(wave.data);
+            buffer.assign(samples, samples + assets::dataSize(asset.kind, asset.params));
+            UnloadWave(wave);
+        }
+        if (buffer.empty()) {
+            std::cerr << "cannot decode " << path.string() << std::endl;
+            continue;
+        }
+        decoded.buffers.push_back(std::move(buffer));
+        asset.data = decoded.buffers.back();
+        decoded.assets.push_back(std::move(asset));
+    }
+    return decoded;
+}
+
+// Reads every byte, so the mapped bundle is paged in like the decoded files are written
+auto checksum(std::span<assets::Asset const> assets) -> uint64_t {
+    uint64_t sum = 0;
+    for (auto const& asset : assets) {
+        for (uint8_t byte : asset.data) {
+            sum = sum * 31 + byte;
+        }
+    }
+    return sum;
+}
+
+auto runPack(std::string const& directory, std::string const& bundle_path) -> int {
+    DecodedAssets decoded = decodeAssets(directory);
+    if (!assets::writeBundleFile(bundle_path, decoded.assets)) {
+        std::cerr << "cannot write " << bundle_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    for (auto const& asset : decoded.assets) {
+        std::cout << asset.name << ": " << asset.data.size() << " bytes\n";
+    }
+    std::cout << "packed " << decoded.assets.size() << " assets into " << bundle_path << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// What differs at startup: decoding the files against mapping the bundle. Uploading to the GPU and the audio device
+// costs the same either way and needs a window, so it is left out.
+auto runMeasure(std::string const& directory, std::string const& bundle_path, size_t repetitions) -> int {
+    using Clock = std::chrono::steady_clock;
+    auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    double loose_total = 0;
+    double loose_min = 1e300;
+    double bundle_total = 0;
+    double bundle_min = 1e300;
+    uint64_t loose_sum = 0;
+    uint64_t bundle_sum = 0;
+    size_t num_assets = 0;
+    for (size_t i = 0; i < repetitions; i++) {
+        auto start = Clock::now();
+        loose_sum = checksum(decodeAssets(directory).assets);
+        double const loose = milliseconds(Clock::now() - start);
+        start = Clock::now();
+        {
+            assets::Bundle const bundle{bundle_path};
+            bundle_sum = checksum(bundle.assets);
+            num_assets = bundle.assets.size();
+        }
+        double const mapped = milliseconds(Clock::now() - start);
+        loose_total += loose;
+        loose_min = std::min(loose_min, loose);
+        bundle_total += mapped;
+        bundle_min = std::min(bundle_min, mapped);
+    }
+    auto const n = static_cast<double>(repetitions);
+    std::cout << "assets: " << num_assets << " repetitions: " << repetitions << "\n";
+    std::cout << "loose files: mean " << loose_total / n << " ms min " << loose_min << " ms\n";
+    std::cout << "bundle:      mean " << bundle_total / n << " ms min " << bundle_min << " ms\n";
+    std::cout << "speedup: " << loose_total / bundle_total << "x" << std::endl;
+    if (num_assets == 0 || loose_sum != bundle_sum) {
+        std::cerr << "the bundle does not match the files in " << directory << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    SetTraceLogLevel(LOG_WARNING);
+    if (argc > 3 && std::string_view{argv[1]} == "measure") {
+        size_t repetitions = argc > 4 ? std::max<size_t>(1, std::strtoul(argv[4], nullptr, 10)) : 20;
+        return runMeasure(argv[2], argv[3], repetitions);
+    }
+    if (argc != 3) {
+        std::cerr << "usage: asset_pack <assets dir> <bundle>\n"
+                     "       asset_pack measure <assets dir> <bundle> [repetitions]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    return runPack(argv[1], argv[2]);
+}
@@ -0,0 +1,585 @@
+#include "alloc_count.hpp"
+#include "bench.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "pcg32.hpp"
+#include "pong.h"
+#include "random_player.hpp"
+#include "render.hpp"
+#include "snake.h"
+#include "snake_autopilot.hpp"
+#include "snake_logic.hpp"
+#include "snapshot.hpp"
+#include "tetris.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Micro-benchmarks of the per-frame hot paths of the three games. Runs headless: the only raylib calls made are the
+// GetRandomValue and CheckCollisionCircleRec of pong.h, which need no window.
+//
+//   bench [--format table|csv|json] [--filter substring] [--warmup n] [--reps n] [--min-time ms] [--list]
+
+namespace {
+
+constexpr uint32_t seed = 1;
+// Query sets are a power of two so the benchmark loops can wrap with a mask
+constexpr size_t num_queries = 4096;
+
+// Snapshots a board every few locked pieces of random play, the same corpus tetris_batch movegen uses
+auto collectBoards(size_t num_boards) -> std::vector<tetris::Board> {
+    constexpr size_t pieces_between_snapshots = 4;
+    std::vector<tetris::Board> corpus;
+    corpus.reserve(num_boards);
+    for (uint32_t game = 0; corpus.size() < num_boards; game++) {
+        tetris::Board board{seed + game};
+        tetris::RandomPlayer player{(seed + game) ^ 0x9e3779b9U};
+        size_t next_snapshot = pieces_between_snapshots;
+        for (double now = 0; board.running && corpus.size() < num_boards && now < 3600; now += 1 / 60.0) {
+            board.update(now, player.next());
+            if (board.running && board.pieces_locked >= next_snapshot) {
+                corpus.push_back(board);
+                next_snapshot += pieces_between_snapshots;
+            }
+        }
+    }
+    return corpus;
+}
+
+struct PieceQuery {
+    uint32_t board;
+    tetris::Tetromino type;
+    tetris::Orientation orientation;
+    ivec2 position;
+    bool clockwise;
+};
+
+auto randomQuery(rng::Pcg32& g, size_t num_boards) -> PieceQuery {
+    return PieceQuery{
+        .board = g.bounded(static_cast<uint32_t>(num_boards)),
+        .type = static_cast<tetris::Tetromino>(g.bounded(tetris::NUM_TETROMINOS)),
+        .orientation = static_cast<tetris::Orientation>(g.bounded(tetris::Orientation::NUM_ORIENTATIONS)),
+        .position = {static_cast<int>(g.bounded(tetris::num_cols + 2)) - 2,
+                     static_cast<int>(g.bounded(tetris::num_rows))},
+        .clockwise = g.bounded(2) == 1,
+    };
+}
+
+// Index of the first SRS test that fits, num_wall_tests if the rotation is blocked
+auto kickIndex(tetris::Board const& board, PieceQuery const& q) -> size_t {
+    tetris::WallTests const& wall_tests =
+        q.type == tetris::I ? tetris::wall_kick_tests_i : tetris::wall_kick_tests_not_i;
+    tetris::Orientation const rotated = q.clockwise ? q.orientation++ : q.orientation--;
+    auto const& tests = wall_tests[q.orientation][static_cast<size_t>(q.clockwise)];
+    for (size_t k = 0; k < tests.size(); k++) {
+        if (!board.collisionCheck(q.type, ivec2{q.position.x + tests[k].x, q.position.y - tests[k].y}, rotated)) {
+            return k;
+        }
+    }
+    return tests.size();
+}
+
+void addTetrisCases(std::vector<bench::Case>& cases) {
+    auto corpus = bench::lazy([] { return collectBoards(256); });
+
+    cases.push_back({"tetris/collisionCheck", [corpus] {
+                         rng::Pcg32 g{seed, 1};
+                         std::vector<PieceQuery> queries;
+                         for (size_t i = 0; i < num_queries; i++) {
+                             queries.push_back(randomQuery(g, corpus->get().size()));
+                         }
+                         return bench::Run{[corpus, queries](size_t n) {
+                             std::vector<tetris::Board> const& boards = corpus->get();
+                             uint64_t hits = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 PieceQuery const& q = queries[i & (num_queries - 1)];
+                                 hits += boards[q.board].collisionCheck(q.type, q.position, q.orientation) ? 1 : 0;
+                             }
+                             return hits;
+                         }};
+                     }});
+
+    // Every piece type at every column it can spawn in, so the ghost drops over the whole surface
+    cases.push_back({"tetris/updateGhostPiece", [corpus] {
+                         rng::Pcg32 g{seed, 4};
+                         auto ghost_boards = std::make_shared<std::vector<tetris::Board>>();
+                         for (size_t i = 0; ghost_boards->size() < num_queries / 16; i++) {
+                             tetris::Board board = corpus->get()[i % corpus->get().size()];
+                             board.active_piece.reset(
+                                 static_cast<tetris::Tetromino>(g.bounded(tetris::NUM_TETROMINOS)));
+                             tetris::Piece& piece = board.active_piece;
+                             piece.orientation =
+                                 static_cast<tetris::Orientation>(g.bounded(tetris::Orientation::NUM_ORIENTATIONS));
+                             piece.position.x = static_cast<int>(g.bounded(tetris::num_cols + 2)) - 2;
+                             if (!board.collisionCheck(piece.type, piece.position, piece.orientation)) {
+                                 ghost_boards->push_back(std::move(board));
+                             }
+                         }
+                         return bench::Run{[ghost_boards](size_t n) {
+                             uint64_t rows = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 tetris::Board& board = (*ghost_boards)[i % ghost_boards->size()];
+                                 board.updateGhostPiece();
+                                 rows += static_cast<uint64_t>(board.ghost_piece.position.y);
+                             }
+                             return rows;
+                         }};
+                     }});
+
+    // One to four full rows at the bottom of each board. Every operation first restores the rows, the colour grid and
+    // the column heights it clears, about 0.5 KB of copying.
+    cases.push_back({"tetris/clearLines", [corpus] {
+                         struct ClearCase {
+                             tetris::Board board;
+                             int top;
+                         };
+                         auto clear_cases = std::make_shared<std::vector<ClearCase>>();
+                         for (size_t i = 0; i < 64; i++) {
+                             tetris::Board board = corpus->get()[i % corpus->get().size()];
+                             int const lines = static_cast<int>(i % 4) + 1;
+                             int const top = tetris::num_rows - lines;
+                             for (int row = top; row < tetris::num_rows; row++) {
+                                 for (int col = 0; col < tetris::num_cols; col++) {
+                                     if (!board.state[row][col].has_value()) {
+                                         board.setCell(row, col, tetris::garbage_cell);
+                                     }
+                                 }
+                             }
+                             clear_cases->push_back({std::move(board), top});
+                         }
+                         auto work = std::make_shared<tetris::Board>(corpus->get().front());
+                         return bench::Run{[clear_cases, work](size_t n) {
+                             uint64_t cleared = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 ClearCase const& c = (*clear_cases)[i % clear_cases->size()];
+                                 work->rows = c.board.rows;
+                                 work->state = c.board.state;
+                                 work->column_heights = c.board.column_heights;
+                                 cleared += work->clearLines(c.top, tetris::num_rows - 1);
+                             }
+                             return cleared;
+                         }};
+                     }});
+
+    // A reachable placement of the active piece on each board, locked into a fresh copy of the board. The copy is
+    // measured on its own by tetris/boardCopy.
+    auto lock_boards = bench::lazy([corpus] {
+        rng::Pcg32 g{seed, 5};
+        std::vector<tetris::Board> boards;
+        auto generator = std::make_unique<tetris::MoveGenerator>();
+        for (auto const& board : corpus->get()) {
+            auto placements = generator->generate(board, board.active_piece.type);
+            if (placements.empty()) {
+                continue;
+            }
+            tetris::Placement const& p = placements[g.bounded(static_cast<uint32_t>(placements.size()))];
+            tetris::Board& locked = boards.emplace_back(board);
+            locked.active_piece.position = p.position;
+            locked.active_piece.orientation = p.orientation;
+            locked.last_move = p.t_spin;
+        }
+        return boards;
+    });
+    cases.push_back({"tetris/boardCopy", [lock_boards] {
+                         auto work = std::make_shared<tetris::Board>(lock_boards->get().front());
+                         return bench::Run{[lock_boards, work](size_t n) {
+                             std::vector<tetris::Board> const& boards = lock_boards->get();
+                             uint64_t pieces = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 *work = boards[i % boards.size()];
+                                 pieces += work->pieces_locked;
+                             }
+                             return pieces;
+                         }};
+                     }});
+    cases.push_back({"tetris/triggerLock", [lock_boards] {
+                         auto work = std::make_shared<tetris::Board>(lock_boards->get().front());
+                         return bench::Run{[lock_boards, work](size_t n) {
+                             std::vector<tetris::Board> const& boards = lock_boards->get();
+                             uint64_t lines = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 *work = boards[i % boards.size()];
+                                 work->triggerLock(work->last_move);
+                                 lines += work->total_lines_cleared;
+                             }
+                             return lines;
+                         }};
+                     }});
+
+    // Rewind history: one snapshot per frame into a preallocated ring, and loading one back. Compare with boardCopy.
+    constexpr size_t history_frames = 256;
+    auto history = bench::lazy([corpus] {
+        std::cerr << "sizeof(Board): " << sizeof(tetris::Board) << " bytes, sizeof(BoardSnapshot): "
+                  << sizeof(tetris::BoardSnapshot) << " bytes" << std::endl;
+        auto ring = std::make_unique<tetris::SnapshotRing<history_frames>>();
+        for (size_t i = 0; i < history_frames; i++) {
+            ring->save(corpus->get()[i % corpus->get().size()]);
+        }
+        return ring;
+    });
+    cases.push_back({"tetris/snapshotSave", [corpus, history] {
+                         return bench::Run{[corpus, history](size_t n) {
+                             std::vector<tetris::Board> const& boards = corpus->get();
+                             tetris::SnapshotRing<history_frames>& ring = *history->get();
+                             for (size_t i = 0; i < n; i++) {
+                                 ring.save(boards[i % boards.size()]);
+                             }
+                             return static_cast<uint64_t>(ring.count);
+                         }};
+                     }});
+    cases.push_back({"tetris/snapshotLoad", [corpus, history] {
+                         auto work = std::make_shared<tetris::Board>(corpus->get().front());
+                         return bench::Run{[history, work](size_t n) {
+                             tetris::SnapshotRing<history_frames> const& ring = *history->get();
+                             uint64_t pieces = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 ring.snapshots[i % history_frames].load(*work);
+                                 pieces += work->pieces_locked;
+                             }
+                             return pieces;
+                         }};
+                     }});
+
+    // Rotations from free positions, bucketed by which SRS test succeeds: kick0 is the unkicked rotation, blocked means
+    // all five tests collide
+    constexpr size_t num_buckets = tetris::num_wall_tests + 1;
+    auto buckets = bench::lazy([corpus] {
+        constexpr size_t queries_per_bucket = 1024;
+        rng::Pcg32 g{seed, 6};
+        std::array<std::vector<PieceQuery>, num_buckets> found;
+        for (size_t attempt = 0; attempt < 4'000'000; attempt++) {
+            PieceQuery q = randomQuery(g, corpus->get().size());
+            tetris::Board const& board = corpus->get()[q.board];
+            if (q.type == tetris::O || board.collisionCheck(q.type, q.position, q.orientation)) {
+                continue;
+            }
+            auto& bucket = found[kickIndex(board, q)];
+            if (bucket.size() < queries_per_bucket) {
+                bucket.push_back(q);
+            }
+        }
+        return found;
+    });
+    for (size_t k = 0; k < num_buckets; k++) {
+        std::string name = k < tetris::num_wall_tests ? "kick" + std::to_string(k) : "blocked";
+        cases.push_back({"tetris/handleRotationTests/" + name, [corpus, buckets, k] {
+                             return bench::Run{[corpus, buckets, k](size_t n) {
+                                 std::vector<PieceQuery> const& bucket = buckets->get()[k];
+                                 uint64_t columns = 0;
+                                 for (size_t i = 0; i < n && !bucket.empty(); i++) {
+                                     PieceQuery const& q = bucket[i % bucket.size()];
+                                     tetris::Board& board = corpus->get()[q.board];
+                                     board.active_piece.type = q.type;
+                                     board.active_piece.position = q.position;
+                                     board.active_piece.orientation = q.orientation;
+                                     board.handleRotationTests(q.orientation, q.clockwise);
+                                     columns += static_cast<uint64_t>(board.active_piece.position.x);
+                                 }
+                                 return columns;
+                             }};
+                         }});
+    }
+}
+
+// A snake of `length` cells winding row by row from the top left corner, head last so it never touches its tail
+auto windingSnake(size_t length) -> snake::Snake {
+    snake::Snake s{{snake::cell_count, snake::cell_count}};
+    s.setBody(snake::windingBody(s.occupancy.size, length));
+    return s;
+}
+
+// Encoding one frame of a snake winding over most of a big grid: every segment as the snake used to draw, and the
+// visible cells only, at the default zoom and zoomed out
+void addSnakeDrawCases(std::vector<bench::Case>& cases, int grid, size_t length) {
+    auto logic = bench::lazy([grid, length] {
+        auto l = std::make_unique<snake::Logic>(ivec2{grid, grid}, seed);
+        l->setWinding(length);
+        return l;
+    });
+    std::string const suffix = "/" + std::to_string(length);
+    cases.push_back({"snake/drawEverySegment" + suffix, [logic] {
+                         auto buffer = std::make_shared<render::CommandBuffer>();
+                         return bench::Run{[logic, buffer](size_t n) {
+                             uint64_t commands = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 buffer->clear();
+                                 for (ivec2 cell : logic->get()->snake.body) {
+                                     constexpr auto size = static_cast<float>(snake::cell_size);
+                                     buffer->roundedRectangle(0, static_cast<float>(cell.x) * size,
+                                                              static_cast<float>(cell.y) * size, size, size, 0.5, 6,
+                                                              snake::dark_green);
+                                 }
+                                 commands += buffer->commands.size();
+                             }
+                             return commands;
+                         }};
+                     }});
+    for (size_t zoom : {size_t{0}, snake::zoom_levels.size() - 1}) {
+        std::string const name = "snake/drawViewport/" + std::to_string(snake::zoom_levels[zoom]) + "px" + suffix;
+        cases.push_back({name, [logic, zoom] {
+                             auto buffer = std::make_shared<render::CommandBuffer>();
+                             snake::Camera camera{{}, zoom};
+                             camera.follow(logic->get()->snake.body.front(), logic->get()->size());
+                             return bench::Run{[logic, buffer, camera](size_t n) {
+                                 uint64_t commands = 0;
+                                 for (size_t i = 0; i < n; i++) {
+                                     buffer->clear();
+                                     snake::drawSnake(*buffer, logic->get()->snake, camera);
+                                     commands += buffer->commands.size();
+                                 }
+                                 return commands;
+                             }};
+                         }});
+    }
+}
+
+// A body of `length` segments moving in a straight line forever: one push at the head and one pop at the tail per tick,
+// on the old std::deque body and on the ring body the snake uses now, sized for the length
+void addSnakeBodyCases(std::vector<bench::Case>& cases, size_t length) {
+    // Kept inside 16 bits, the ring packs coordinates
+    auto step = [](ivec2 head) { return ivec2{(head.x + 1) & 0x3fff, head.y}; };
+
+    std::string const suffix = "/" + std::to_string(length);
+    cases.push_back({"snake/tick/deque" + suffix, [length, step] {
+                         size_t const bytes_before = alloc_count::bytes.load(std::memory_order_relaxed);
+                         auto deque = std::make_shared<std::deque<ivec2>>();
+                         for (size_t i = 0; i < length; i++) {
+                             deque->push_front(step(deque->empty() ? ivec2{} : deque->front()));
+                         }
+                         std::cerr << "snake body of " << length << " segments: std::deque "
+                                   << alloc_count::bytes.load(std::memory_order_relaxed) - bytes_before << " bytes"
+                                   << std::endl;
+                         return bench::Run{[deque, step](size_t n) {
+                             for (size_t i = 0; i < n; i++) {
+                                 deque->push_front(step(deque->front()));
+                                 deque->pop_back();
+                             }
+                             return static_cast<uint64_t>(deque->front().x);
+                         }};
+                     }});
+    cases.push_back({"snake/tick/ring" + suffix, [length, step] {
+                         auto ring = std::make_shared<snake::RingBody>(length + 1);
+                         for (size_t i = 0; i < length; i++) {
+                             ring->push_front(step(ring->size() == 0 ? ivec2{} : ring->front()));
+                         }
+                         std::cerr << "snake body of " << length << " segments: ring "
+                                   << sizeof(snake::RingBody) + ring->capacity() * sizeof(snake::PackedCell)
+                                   << " bytes" << std::endl;
+                         return bench::Run{[ring, step](size_t n) {
+                             for (size_t i = 0; i < n; i++) {
+                                 ring->push_front(step(ring->front()));
+                                 ring->pop_back();
+                             }
+                             return static_cast<uint64_t>(ring->front().x);
+                         }};
+                     }});
+}
+
+void addSnakeCases(std::vector<bench::Case>& cases) {
+    auto cells = bench::lazy([] {
+        rng::Pcg32 g{seed, 2};
+        std::vector<ivec2> c;
+        for (size_t i = 0; i < num_queries; i++) {
+            c.emplace_back(g.bounded(snake::cell_count), g.bounded(snake::cell_count));
+        }
+        return c;
+    });
+    // Up to one free cell on the 25x25 grid
+    for (size_t length : {16, 128, 512, 624}) {
+        std::string const suffix = "/" + std::to_string(length);
+        cases.push_back({"snake/elementInDeque" + suffix, [cells, length] {
+                             snake::Snake const s = windingSnake(length);
+                             auto deque = std::make_shared<std::deque<ivec2>>();
+                             for (ivec2 cell : s.body) {
+                                 deque->push_back(cell);
+                             }
+                             return bench::Run{[deque, cells](size_t n) {
+                                 std::vector<ivec2> const& queries = cells->get();
+                                 uint64_t found = 0;
+                                 for (size_t i = 0; i < n; i++) {
+                                     found += snake::elementInDeque(queries[i & (num_queries - 1)], *deque) ? 1 : 0;
+                                 }
+                                 return found;
+                             }};
+                         }});
+        cases.push_back({"snake/occupies" + suffix, [cells, length] {
+                             auto s = std::make_shared<snake::Snake>(windingSnake(length));
+                             return bench::Run{[s, cells](size_t n) {
+                                 std::vector<ivec2> const& queries = cells->get();
+                                 uint64_t found = 0;
+                                 for (size_t i = 0; i < n; i++) {
+                                     found += s->occupies(queries[i & (num_queries - 1)]) ? 1 : 0;
+                                 }
+                                 return found;
+                             }};
+                         }});
+        cases.push_back({"snake/checkCollisionWithTail" + suffix, [length] {
+                             auto s = std::make_shared<snake::Snake>(windingSnake(length));
+                             return bench::Run{[s](size_t n) {
+                                 uint64_t hits = 0;
+                                 for (size_t i = 0; i < n; i++) {
+                                     hits += s->headHitsTail() ? 1 : 0;
+                                 }
+                                 return hits;
+                             }};
+                         }});
+        cases.push_back({"snake/randomFreeCell" + suffix, [length] {
+                             auto logic =
+                                 std::make_shared<snake::Logic>(ivec2{snake::cell_count, snake::cell_count}, seed);
+                             logic->snake = windingSnake(length);
+                             return bench::Run{[logic](size_t n) {
+                                 uint64_t sum = 0;
+                                 for (size_t i = 0; i < n; i++) {
+                                     ivec2 const pos = logic->randomFreeCell().value_or(ivec2{});
+                                     sum += static_cast<uint64_t>(pos.x * snake::cell_count + pos.y);
+                                 }
+                                 return sum;
+                             }};
+                         }});
+    }
+    for (size_t length : {10, 1000, 100000, 1000000}) {
+        addSnakeBodyCases(cases, length);
+    }
+    addSnakeDrawCases(cases, 1024, 1000000);
+
+    // One autopilot decision and tick on a board it can finish, starting a new game whenever one ends
+    cases.push_back({"snake/autopilotTick", [] {
+                         constexpr ivec2 autopilot_grid{24, 24};
+                         auto pilot = std::make_shared<std::pair<snake::Logic, snake::Autopilot>>(
+                             snake::Logic{autopilot_grid, seed}, snake::Autopilot{autopilot_grid});
+                         return bench::Run{[pilot](size_t n) {
+                             auto& [logic, autopilot] = *pilot;
+                             uint64_t foods = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 logic.steer(autopilot.next(logic));
+                                 foods += logic.step() == snake::Event::Ate ? 1 : 0;
+                             }
+                             return foods;
+                         }};
+                     }});
+}
+
+void addPongCases(std::vector<bench::Case>& cases) {
+    // Ball positions spread over the paddle columns and the open court, where most frames are spent
+    cases.push_back({"pong/paddleCollisions", [] {
+                         rng::Pcg32 g{seed, 3};
+                         auto balls = std::make_shared<std::vector<Ball>>();
+                         for (size_t i = 0; i < num_queries; i++) {
+                             Ball ball{};
+                             ball.position = {static_cast<float>(g.bounded(screen_width)),
+                                              static_cast<float>(g.bounded(screen_height))};
+                             balls->push_back(ball);
+                         }
+                         auto paddles = std::make_shared<std::pair<Paddle, CpuPaddle>>();
+                         return bench::Run{[balls, paddles](size_t n) {
+                             uint64_t hits = 0;
+                             for (size_t i = 0; i < n; i++) {
+                                 Ball const& ball = (*balls)[i & (num_queries - 1)];
+                                 hits += hitsPaddle(ball, paddles->first.position, paddles->first.dimension) ? 1 : 0;
+                                 hits += hitsPaddle(ball, paddles->second.position, paddles->second.dimension) ? 1 : 0;
+                             }
+                             return hits;
+                         }};
+                     }});
+
+    // One frame of the game loop without drawing or keyboard input: the player paddle stays put
+    struct Court {
+        Ball ball;
+        Paddle player;
+        CpuPaddle cpu_player;
+        int player_score = 0;
+        int cpu_score = 0;
+    };
+    cases.push_back({"pong/frame", [] {
+                         auto court = std::make_shared<Court>();
+                         return bench::Run{[court](size_t n) {
+                             Court& c = *court;
+                             for (size_t i = 0; i < n; i++) {
+                                 c.ball.update(c.player_score, c.cpu_score);
+                                 c.cpu_player.update(c.ball.position[1]);
+                                 bounceOffPaddles(c.ball, c.player, c.cpu_player);
+                             }
+                             return static_cast<uint64_t>(c.player_score + c.cpu_score);
+                         }};
+                     }});
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    bench::Options options{};
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        std::string_view const arg{argv[i]};
+        char const* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--list") {
+            list = true;
+        } else if (value == nullptr) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        } else if (arg == "--format") {
+            std::string_view const format{value};
+            options.format = format == "json"  ? bench::Format::Json
+                             : format == "csv" ? bench::Format::Csv
+                                               : bench::Format::Table;
+            i++;
+        } else if (arg == "--filter") {
+            options.filter = value;
+            i++;
+        } else if (arg == "--warmup") {
+            options.warmup = std::strtoul(value, nullptr, 10);
+            i++;
+        } else if (arg == "--reps") {
+            options.repetitions = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+            i++;
+        } else if (arg == "--min-time") {
+            options.min_rep_seconds = std::strtod(value, nullptr) / 1000;
+            i++;
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<bench::Case> cases;
+    addTetrisCases(cases);
+    addSnakeCases(cases);
+    addPongCases(cases);
+
+    std::vector<bench::Result> results;
+    for (auto const& c : cases) {
+        if (c.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        if (list) {
+            std::cout << c.name << "\n";
+            continue;
+        }
+        results.push_back(bench::runCase(c, options));
+        // Progress goes to stderr so the results on stdout stay machine-readable
+        std::cerr << c.name << std::endl;
+    }
+    if (list) {
+        return 0;
+    }
+
+    switch (options.format) {
+    case bench::Format::Table:
+        bench::writeTable(std::cout, results);
+        break;
+    case bench::Format::Csv:
+        bench::writeCsv(std::cout, results);
+        break;
+    case bench::Format::Json:
+        bench::writeJson(std::cout, results, options);
+        break;
+    }
+    return 0;
+}
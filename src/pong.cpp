@@ -1,6 +1,9 @@
 #include "pong.h"
 #include "glm/glm.hpp"
 #include "raylib.h"
+#include "render.hpp"
+#include "render_raylib.hpp"
+#include "trace.hpp"
 
 auto main() -> int {
     Ball ball{};
@@ -9,6 +12,7 @@ auto main() -> int {
 
     int player_score = 0;
     int cpu_score = 0;
+    render::CommandBuffer frame;
 
     InitWindow(screen_width, screen_height, "pong");
 
@@ -18,38 +22,43 @@ auto main() -> int {
 
     // Game Loop
     while (!WindowShouldClose()) {
+        TRACE_SCOPE("frame");
         // 1. Event handling
 
         // 2. Updating Positions
-        ball.update(player_score, cpu_score);
-        cpu_player.update(ball.position[1]);
-        player.update();
+        {
+            TRACE_SCOPE("update");
+            ball.update(player_score, cpu_score);
+            cpu_player.update(ball.position[1]);
+            player.update();
+        }
 
         // Checking for collisions
-        if (CheckCollisionCircleRec(
-                toVector2(ball.position), ball.radius,
-                Rectangle{player.position[0], player.position[1], player.dimension[0], player.dimension[1]})) {
-            ball.velocity[0] = -ball.velocity[0];
-        }
-        if (CheckCollisionCircleRec(toVector2(ball.position), ball.radius,
-                                    Rectangle{cpu_player.position[0], cpu_player.position[1], cpu_player.dimension[0],
-                                              cpu_player.dimension[1]})) {
-            ball.velocity[0] = -ball.velocity[0];
+        {
+            TRACE_SCOPE("collision");
+            bounceOffPaddles(ball, player, cpu_player);
         }
 
         // 3. Drawing
         BeginDrawing();
         ClearBackground(BLACK);
-        DrawLine(screen_width / 2, 0, screen_width / 2, screen_height, WHITE);
-        ball.draw();
-        cpu_player.draw();
-        player.draw();
-        DrawText(TextFormat("%i", cpu_score), screen_width / 4 - 20, 20, 80, WHITE);
-        DrawText(TextFormat("%i", player_score), 3 * screen_width / 4 - 20, 20, 80, WHITE);
+        {
+            TRACE_SCOPE("draw");
+            frame.clear();
+            frame.line(BackgroundLayer, screen_width / 2, 0, screen_width / 2, screen_height, render::white);
+            ball.draw(frame);
+            cpu_player.draw(frame);
+            player.draw(frame);
+            frame.textf(ObjectLayer, screen_width / 4 - 20, 20, 80, render::white, "%i", cpu_score);
+            frame.textf(ObjectLayer, 3 * screen_width / 4 - 20, 20, 80, render::white, "%i", player_score);
+            frame.sort();
+            render::RaylibBackend::submit(frame);
+        }
 
         EndDrawing();
     }
 
     CloseWindow();
+    TRACE_WRITE("pong_trace.json");
     return 0;
 }
\ No newline at end of file
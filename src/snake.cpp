@@ -1,212 +1,123 @@
+#include "snake.h"
+#include "asset_bundle.hpp"
 #include "raylib.h"
+#include "render.hpp"
+#include "render_raylib.hpp"
+#include "snake_autopilot.hpp"
+#include "snake_input.hpp"
+#include "trace.hpp"
 #include <algorithm>
-#include <deque>
-#include <glm/fwd.hpp>
-#include <glm/glm.hpp>
-
-constexpr int screen_width = 750;
-constexpr int screen_height = 750;
-
-constexpr Color green = {173, 204, 96, 255};
-constexpr Color dark_green = {43, 51, 24, 255};
-
-constexpr int cell_size = 30;
-constexpr int cell_count = 25;
-constexpr int offset = 75;
-
-using namespace glm;
-
-auto elementInDeque(ivec2 el, std::deque<ivec2> deq) -> bool {
-    return std::any_of(deq.begin(), deq.end(), [el](ivec2 x) { return el == x; });
-};
-
-struct Snake {
-    std::deque<ivec2> body = {ivec2{6, 9}, ivec2{5, 9}, ivec2{4, 9}};
-    ivec2 direction = {1, 0};
-    bool add_segment = false;
-
-    void reset() {
-        body = {ivec2{6, 9}, ivec2{5, 9}, ivec2{4, 9}};
-        direction = {1, 0};
-        add_segment = false;
-    }
-
-    void draw() {
-        for (auto& cell : body) {
-            Rectangle r{.x = static_cast<float>(offset + cell[0] * cell_size),
-                        .y = static_cast<float>(offset + cell[1] * cell_size),
-                        .width = cell_size,
-                        .height = cell_size};
-            DrawRectangleRounded(r, 0.5, 6, dark_green);
-        }
-    }
-
-    void update() {
-        body.push_front(body[0] + direction);
-        if (add_segment) {
-            add_segment = false;
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace snake;
+
+// Options:
+//   --autopilot      let the autopilot play, restarting after every game
+//   --grid <n>       cells per side, 25 by default and up to 2048; the view scrolls with the head and -/= zoom
+//   --length <n>     start with a snake this long, winding over the top rows
+//   --next-frame     move on the frame after a turn key instead of at the next tick
+//   --loose-assets   decode the files in assets/ instead of mapping assets.bundle from the executable's directory
+//
+// Prints how long the window and the assets took to load.
+auto main(int argc, char** argv) -> int {
+    bool autopilot_mode = false;
+    int grid = cell_count;
+    size_t length = 0;
+    bool loose_assets_mode = false;
+    Ticker ticker;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "--autopilot") {
+            autopilot_mode = true;
+        } else if (arg == "--loose-assets") {
+            loose_assets_mode = true;
+        } else if (arg == "--next-frame") {
+            ticker.apply_on_next_frame = true;
+        } else if (arg == "--grid" && i + 1 < argc) {
+            grid = std::clamp(std::atoi(argv[++i]), 4, 2048);
+        } else if (arg == "--length" && i + 1 < argc) {
+            length = std::strtoul(argv[++i], nullptr, 10);
         } else {
-            body.pop_back();
-        }
-    }
-};
-
-struct Food {
-    ivec2 position{};
-    Texture2D texture{};
-
-    explicit Food(const std::deque<ivec2>& snake_body) {
-        Image image = LoadImage("assets/food.png");
-        texture = LoadTextureFromImage(image);
-        position = generateRandomPos(snake_body);
-        UnloadImage(image);
-    }
-    ~Food() { UnloadTexture(texture); }
-    Food(const Food&) = default;
-    Food(Food&&) = delete;
-    Food& operator=(const Food&) = default;
-    Food& operator=(Food&&) = delete;
-
-    void draw() { DrawTexture(texture, offset + position[0] * cell_size, offset + position[1] * cell_size, WHITE); }
-    static auto generateRandomPos(const std::deque<ivec2>& snake_body) -> ivec2 {
-        auto generateRandomCell = []() -> ivec2 {
-            int x = GetRandomValue(0, cell_count - 1);
-            int y = GetRandomValue(0, cell_count - 1);
-            return {x, y};
-        };
-
-        ivec2 position = generateRandomCell();
-        while (elementInDeque(position, snake_body)) {
-            position = generateRandomCell();
-        }
-
-        return position;
-    }
-};
-
-struct Game {
-    Snake snake{};
-    Food food{snake.body};
-    bool running = true;
-    int score = 0;
-    Sound eat_sound{};
-    Sound wall_sound{};
-
-    Game() {
-        InitAudioDevice();
-        eat_sound = LoadSound("assets/eat.mp3");
-        wall_sound = LoadSound("assets/wall.mp3");
-    }
-
-    Game(const Game&) = default;
-    Game(Game&&) = delete;
-    Game& operator=(const Game&) = default;
-    Game& operator=(Game&&) = delete;
-    ~Game() {
-        UnloadSound(eat_sound);
-        UnloadSound(wall_sound);
-        CloseAudioDevice();
-    }
-
-    void draw() {
-        food.draw();
-        snake.draw();
-    }
-
-    void update() {
-        if (running) {
-            snake.update();
-            checkCollisionWithFood();
-            checkCollisionWithEdge();
-            checkCollisionWithTail();
-        }
-    }
-
-    void checkCollisionWithFood() {
-        if (snake.body[0] == food.position) {
-            snake.add_segment = true;
-            food.position = Food::generateRandomPos(snake.body);
-            score++;
-            PlaySound(eat_sound);
+            std::cerr << "unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
         }
     }
 
-    void checkCollisionWithEdge() {
-        if (snake.body[0][0] == cell_count || snake.body[0][0] == -1 || snake.body[0][1] == cell_count ||
-            snake.body[0][1] == -1) {
-            gameOver();
-        }
-    }
-
-    void checkCollisionWithTail() {
-        std::deque<ivec2> headless_body = snake.body;
-        headless_body.pop_front();
-        if (elementInDeque(snake.body[0], headless_body)) {
-            gameOver();
-        }
-    }
-
-    void gameOver() {
-        snake.reset();
-        food.position = Food::generateRandomPos(snake.body);
-        running = false;
-        score = 0;
-        PlaySound(wall_sound);
+    auto const start = std::chrono::steady_clock::now();
+    InitWindow(2 * offset + view_pixels, 2 * offset + view_pixels, "snake");
+    SetTargetFPS(60);
+    auto const window_ready = std::chrono::steady_clock::now();
+
+    // The mapping is only read while the game loads, uploads copy out of it
+    assets::Bundle const bundle{loose_assets_mode ? "" : std::string{GetApplicationDirectory()} + "assets.bundle"};
+    Game game{{grid, grid}, static_cast<uint64_t>(GetRandomValue(0, INT_MAX)), bundle};
+    auto const assets_ready = std::chrono::steady_clock::now();
+    std::cout << "startup: window " << std::chrono::duration<double, std::milli>(window_ready - start).count()
+              << " ms, assets from " << (bundle.assets.empty() ? "loose files " : "the bundle ")
+              << std::chrono::duration<double, std::milli>(assets_ready - window_ready).count() << " ms" << std::endl;
+    if (length > 0) {
+        game.logic.setWinding(length);
     }
-};
-
-auto event_triggered(double interval) -> bool {
-    static double last_update_time = 0;
-    double current_time = GetTime();
-    if (current_time - last_update_time >= interval) {
-        last_update_time = current_time;
-        return true;
+    game.camera.follow(game.logic.snake.body.front(), game.logic.size());
+    std::optional<Autopilot> autopilot;
+    if (autopilot_mode) {
+        autopilot.emplace(game.logic.size());
     }
-    return false;
-}
-
-auto main() -> int {
-    InitWindow(2 * offset + cell_size * cell_count, 2 * offset + cell_size * cell_count, "snake");
-    SetTargetFPS(60);
-
-    Game game{};
+    render::CommandBuffer frame;
 
     while (!WindowShouldClose()) {
+        TRACE_SCOPE("frame");
         BeginDrawing();
 
-        if (event_triggered(0.2)) {
-            // std::cout << GetTime() << std::endl;
-            game.update();
+        // Turns are queued with the frame time and taken one per tick
+        double const now = GetTime();
+        ivec2 const heading = game.logic.snake.direction;
+        if (IsKeyPressed(KEY_UP)) {
+            ticker.press({now, {0, -1}}, heading);
         }
-
-        if (IsKeyPressed(KEY_UP) && game.snake.direction[1] != 1) {
-            game.snake.direction = {0, -1};
-            game.running = true;
+        if (IsKeyPressed(KEY_DOWN)) {
+            ticker.press({now, {0, 1}}, heading);
+        }
+        if (IsKeyPressed(KEY_LEFT)) {
+            ticker.press({now, {-1, 0}}, heading);
         }
-        if (IsKeyPressed(KEY_DOWN) && game.snake.direction[1] != -1) {
-            game.snake.direction = {0, 1};
-            game.running = true;
+        if (IsKeyPressed(KEY_RIGHT)) {
+            ticker.press({now, {1, 0}}, heading);
         }
-        if (IsKeyPressed(KEY_LEFT) && game.snake.direction[0] != 1) {
-            game.snake.direction = {-1, 0};
-            game.running = true;
+        ticker.update(now, [&](std::optional<ivec2> turn) {
+            if (autopilot) {
+                game.logic.steer(autopilot->next(game.logic));
+            } else if (turn) {
+                game.logic.steer(*turn);
+            }
+            return game.update();
+        });
+        if (IsKeyPressed(KEY_MINUS)) {
+            game.camera.zoomOut();
+            game.camera.follow(game.logic.snake.body.front(), game.logic.size());
         }
-        if (IsKeyPressed(KEY_RIGHT) && game.snake.direction[0] != -1) {
-            game.snake.direction = {1, 0};
-            game.running = true;
+        if (IsKeyPressed(KEY_EQUAL)) {
+            game.camera.zoomIn();
+            game.camera.follow(game.logic.snake.body.front(), game.logic.size());
         }
 
         // Drawing
-        ClearBackground(green);
-        DrawRectangleLinesEx(
-            Rectangle{offset - 5, offset - 5, cell_size * cell_count + 10, cell_size * cell_count + 10}, 5, dark_green);
-        DrawText("Retro Snake", offset - 5, 20, 40, dark_green);
-        DrawText(TextFormat("%i", game.score), offset - 5, offset + cell_size * cell_count + 10, 40, dark_green);
-        game.draw();
+        ClearBackground(render::toRaylib(green));
+        frame.clear();
+        game.draw(frame);
+        render::RaylibBackend::submit(frame);
 
         EndDrawing();
     }
 
     CloseWindow();
+    TRACE_WRITE("snake_trace.json");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "pcg32.hpp"
+#include "snake_autopilot.hpp"
+#include "snake_input.hpp"
+#include "snake_logic.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Headless snake runner: the autopilot plays whole games on the logic core, seeded, no window or audio, spread over
+// every core. Prints a summary that can be diffed between builds.
+//
+//   snake_batch [games] [width] [height] [seed]
+//   snake_batch input [streams] [seed]    replays synthetic turn key streams through the input handling, exits non-zero
+//                                          if a scripted stream doesn't end where expected
+namespace {
+
+struct GameResult {
+    bool won = false;
+    // Ran out of ticks without eating, the autopilot went round in circles
+    bool stalled = false;
+    size_t foods = 0;
+    size_t ticks = 0;
+    // Cells the snake covered at its longest, the whole grid for a won game
+    size_t length = 0;
+};
+
+auto playGame(snake::ivec2 size, uint64_t seed) -> GameResult {
+    snake::Logic logic{size, seed};
+    snake::Autopilot pilot{size};
+    GameResult result{};
+    size_t const max_ticks_per_food = 4 * static_cast<size_t>(size.x * size.y);
+    size_t last_food_tick = 0;
+    while (true) {
+        logic.steer(pilot.next(logic));
+        snake::Event const event = logic.step();
+        result.ticks++;
+        if (event == snake::Event::Ate || event == snake::Event::Won) {
+            result.foods++;
+            last_food_tick = result.ticks;
+        }
+        if (event == snake::Event::Won || event == snake::Event::Died) {
+            result.won = event == snake::Event::Won;
+            if (result.won) {
+                result.length = static_cast<size_t>(size.x * size.y);
+            }
+            return result;
+        }
+        result.length = std::max(result.length, logic.snake.body.size());
+        if (result.ticks - last_food_tick > max_ticks_per_food) {
+            result.stalled = true;
+            return result;
+        }
+    }
+}
+
+using snake::ivec2;
+using snake::Ticker;
+using snake::TurnEvent;
+
+// How turn keys reach the game. LastKey is how snake used to poll them: a press steers straight away, so only the last
+// one before a tick counts and it is only checked against the current direction.
+enum class InputMode : uint8_t { LastKey, Queued, NextFrame };
+
+constexpr std::array<char const*, 3> input_mode_names = {"last key", "queued", "next frame"};
+
+struct TurnResult {
+    ivec2 head{};
+    bool died = false;
+    size_t presses = 0;
+    // Presses that turned the snake, and the seconds from press to move summed over them
+    size_t applied = 0;
+    double latency = 0;
+};
+
+// Plays `stream` on a game stepped at `fps` until `end` or the snake dies, delivering each press on the first frame at
+// or after it happens. The default snake starts at (6, 9) heading right, `start` replaces it.
+auto replayTurns(std::span<TurnEvent const> stream, InputMode mode, int fps, double end, ivec2 grid_size,
+                 std::span<ivec2 const> start = {}) -> TurnResult {
+    snake::Logic logic{grid_size, 1};
+    if (!start.empty()) {
+        logic.snake.setBody(start);
+    }
+    Ticker ticker;
+    ticker.apply_on_next_frame = mode == InputMode::NextFrame;
+    TurnResult result{};
+    // When the last-key press that has steered the snake but not moved it yet happened, negative if there is none
+    double pending = -1;
+    size_t next = 0;
+    for (int frame = 1; !result.died; frame++) {
+        double const now = static_cast<double>(frame) / fps;
+        if (now > end) {
+            break;
+        }
+        for (; next < stream.size() && stream[next].time <= now; next++) {
+            result.presses++;
+            if (mode == InputMode::LastKey) {
+                ivec2 const before = logic.snake.direction;
+                logic.steer(stream[next].direction);
+                if (logic.snake.direction != before) {
+                    pending = stream[next].time;
+                }
+            } else {
+                ticker.press(stream[next], logic.snake.direction);
+            }
+        }
+        std::optional<double> const queued_time =
+            ticker.turns.empty() ? std::nullopt : std::optional{ticker.turns.front().time};
+        ticker.update(now, [&](std::optional<ivec2> turn) {
+            if (turn && *turn != logic.snake.direction) {
+                logic.steer(*turn);
+                result.applied++;
+                result.latency += now - queued_time.value();
+            } else if (pending >= 0) {
+                result.applied++;
+                result.latency += now - pending;
+            }
+            pending = -1;
+            return logic.step();
+        });
+        result.died = !logic.running;
+        result.head = logic.snake.body.front();
+    }
+    return result;
+}
+
+// Turns every 0.25 to 1 s, and a third of the time a quick second turn 20 to 80 ms after the first, each at right
+// angles to the previous one as a player would mean them
+auto randomTurns(uint64_t seed, double duration) -> std::vector<TurnEvent> {
+    rng::Pcg32 g{seed, 5};
+    std::vector<TurnEvent> stream;
+    ivec2 direction{1, 0};
+    double time = 0;
+    while (true) {
+        bool const quick = !stream.empty() && g.bounded(3) == 0;
+        time += quick ? 0.020 + 0.001 * g.bounded(61) : 0.25 + 0.001 * g.bounded(751);
+        if (time > duration) {
+            return stream;
+        }
+        direction = g.bounded(2) == 0 ? ivec2{-direction.y, direction.x} : ivec2{direction.y, -direction.x};
+        stream.push_back({time, direction});
+    }
+}
+
+auto runInput(size_t num_streams, uint64_t seed) -> int {
+    constexpr ivec2 default_grid{25, 25};
+    constexpr ivec2 up{0, -1};
+    constexpr ivec2 down{0, 1};
+    constexpr ivec2 left{-1, 0};
+    constexpr ivec2 right{1, 0};
+    struct Case {
+        char const* name;
+        std::vector<TurnEvent> stream;
+        double end;
+        // Where the head should be with queued and next frame input
+        ivec2 queued;
+        ivec2 next_frame;
+    };
+    // Ticks come every 0.2 s from 0.2 s on, or from the frame after a press in next frame mode
+    std::vector<Case> const cases = {
+        {"two turns in one tick", {{0.05, up}, {0.08, left}}, 0.5, {5, 8}, {4, 8}},
+        {"reversal of the queued turn", {{0.05, up}, {0.08, down}}, 0.5, {6, 7}, {6, 6}},
+        // The press in the current direction is queued and takes a tick without turning
+        {"turn into the current direction", {{0.05, right}, {0.08, up}}, 0.5, {7, 8}, {7, 7}},
+        // Next frame takes the first turn before the last press, so the queue has room for it
+        {"more turns than the queue holds",
+         {{0.05, up}, {0.06, left}, {0.07, down}, {0.08, left}, {0.09, up}},
+         1.05,
+         {3, 9},
+         {4, 6}},
+        {"next frame", {{0.05, up}, {0.06, left}}, 0.25, {6, 8}, {5, 8}},
+    };
+    constexpr std::array<int, 3> frame_rates = {30, 60, 240};
+    bool ok = true;
+    for (auto const& c : cases) {
+        std::cout << c.name << ":";
+        for (InputMode mode : {InputMode::LastKey, InputMode::Queued, InputMode::NextFrame}) {
+            std::cout << " " << input_mode_names[static_cast<size_t>(mode)];
+            for (int fps : frame_rates) {
+                TurnResult const r = replayTurns(c.stream, mode, fps, c.end, default_grid);
+                std::optional<ivec2> const expected = mode == InputMode::Queued      ? std::optional{c.queued}
+                                                      : mode == InputMode::NextFrame ? std::optional{c.next_frame}
+                                                                                     : std::nullopt;
+                bool const match = !expected || (!r.died && r.head == *expected);
+                ok = ok && match;
+                std::cout << " (" << (r.died ? "died" : std::to_string(r.head.x) + "," + std::to_string(r.head.y))
+                          << (match ? "" : " unexpected") << ")";
+            }
+        }
+        std::cout << "\n";
+    }
+
+    // A game over resets the snake heading right, pressing right has to start the next game
+    snake::Logic restart{default_grid, 1};
+    while (restart.step() != snake::Event::Died) {
+    }
+    Ticker ticker;
+    ticker.press({0, right}, restart.snake.direction);
+    ticker.update(ticker.interval, [&](std::optional<ivec2> turn) {
+        if (turn) {
+            restart.steer(*turn);
+        }
+        return restart.step();
+    });
+    ok = ok && restart.running;
+    std::cout << "restart with the heading key: " << (restart.running ? "started" : "not started, unexpected") << "\n";
+
+    // A short snake in the middle of a big grid, so only turning back into itself can kill it
+    constexpr ivec2 open_grid{1001, 1001};
+    std::array<ivec2, 3> const start = {ivec2{500, 500}, ivec2{499, 500}, ivec2{498, 500}};
+    constexpr double duration = 60;
+    for (InputMode mode : {InputMode::LastKey, InputMode::Queued, InputMode::NextFrame}) {
+        size_t deaths = 0;
+        size_t presses = 0;
+        size_t applied = 0;
+        double latency = 0;
+        for (size_t i = 0; i < num_streams; i++) {
+            std::vector<TurnEvent> const stream = randomTurns(seed + i, duration);
+            TurnResult const r = replayTurns(stream, mode, 60, duration, open_grid, start);
+            deaths += r.died ? 1 : 0;
+            presses += r.presses;
+            applied += r.applied;
+            latency += r.latency;
+        }
+        std::cout << input_mode_names[static_cast<size_t>(mode)] << ": streams: " << num_streams
+                  << " died: " << deaths << " turns applied: " << applied << " of " << presses
+                  << " mean press to move: " << 1000 * latency / static_cast<double>(std::max<size_t>(applied, 1))
+                  << " ms\n";
+    }
+    std::cout << (ok ? "turn input behaves as expected" : "turn input differs") << std::endl;
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc > 1 && std::string_view{argv[1]} == "input") {
+        size_t num_streams = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+        uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+        return runInput(num_streams, seed);
+    }
+    size_t num_games = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    int width = argc > 2 ? std::max(4, std::atoi(argv[2])) : 10;
+    int height = argc > 3 ? std::max(4, std::atoi(argv[3])) : width;
+    uint64_t seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1;
+    size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    std::vector<GameResult> results(num_games);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < num_threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < num_games; i += num_threads) {
+                results[i] = playGame({width, height}, seed + i);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t won = 0;
+    size_t stalled = 0;
+    size_t foods = 0;
+    size_t ticks = 0;
+    size_t covered = 0;
+    size_t lost_covered = 0;
+    uint64_t checksum = 0;
+    for (auto const& r : results) {
+        won += r.won ? 1 : 0;
+        stalled += r.stalled ? 1 : 0;
+        foods += r.foods;
+        ticks += r.ticks;
+        covered += r.length;
+        lost_covered += r.won ? 0 : r.length;
+        checksum = checksum * 31 + r.ticks * 7 + r.foods * 3 + (r.won ? 1 : 0);
+    }
+
+    std::cout << "games: " << num_games << " threads: " << num_threads << " grid: " << width << "x" << height << "\n";
+    std::cout << "completed: " << won << " (" << 100.0 * static_cast<double>(won) / static_cast<double>(num_games)
+              << "%) died: " << num_games - won - stalled << " stalled: " << stalled << " checksum: " << checksum
+              << "\n";
+    // Share of the grid the snake covered at its longest. A lost game can end a cell short of the board, so the games
+    // that were not won are shown on their own.
+    auto const cells = static_cast<double>(width * height);
+    std::cout << "average fill: " << 100.0 * static_cast<double>(covered) / (static_cast<double>(num_games) * cells)
+              << "%";
+    if (won < num_games) {
+        std::cout << ", games not won: "
+                  << 100.0 * static_cast<double>(lost_covered) / (static_cast<double>(num_games - won) * cells) << "%";
+    }
+    std::cout << "\n";
+    std::cout << "moves per food: " << static_cast<double>(ticks) / static_cast<double>(std::max<size_t>(foods, 1))
+              << " elapsed: " << elapsed << "s ticks/s: " << static_cast<double>(ticks) / elapsed << std::endl;
+    return 0;
+}
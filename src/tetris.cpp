@@ -1,23 +1,126 @@
-#include "tetris.hpp"
 #include "board.hpp"
+#include "bot.hpp"
+#include "frontend.hpp"
 #include "raylib.h"
+#include "render.hpp"
+#include "render_raylib.hpp"
+#include "replay.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+// Options:
+//   --bot            let the beam search bot play
+//   --record <file>  save a replay of the game when it ends or the window is closed
+//   --mt19937        use the original std::mt19937 randomizer instead of PCG32
+// Holding backspace rewinds the game a frame per frame, except with --bot or --record
+constexpr double bot_piece_interval = 0.1;
+// Three seconds at the target frame rate
+constexpr size_t rewind_frames = 720;
+
+auto main(int argc, char** argv) -> int {
+    bool bot_mode = false;
+    auto randomizer = tetris::RandomizerKind::Pcg32;
+    std::optional<std::string> record_path;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg{argv[i]};
+        if (arg == "--bot") {
+            bot_mode = true;
+        } else if (arg == "--mt19937") {
+            randomizer = tetris::RandomizerKind::Mt19937;
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        }
+    }
+    if (bot_mode && record_path.has_value()) {
+        std::cerr << "--record is ignored in bot mode, the bot does not play through inputs" << std::endl;
+        record_path.reset();
+    }
 
-auto main() -> int {
     InitWindow(tetris::screen_width, tetris::screen_height, "Tetris");
     SetTargetFPS(240);
 
-    tetris::Board board{};
+    uint32_t seed = std::random_device{}();
+    tetris::Board board{seed, randomizer};
+    std::optional<tetris::Bot> bot;
+    if (bot_mode) {
+        bot.emplace();
+    }
+    std::optional<tetris::ReplayRecorder> recorder;
+    if (record_path.has_value()) {
+        recorder.emplace(seed, randomizer);
+    }
+    double last_bot_move_time = 0;
+    tetris::KeyboardSampler keyboard;
+    tetris::InputEventQueue events;
+    tetris::StackCache stack;
+    render::CommandBuffer frame;
+    bool const can_rewind = !bot_mode && !record_path.has_value();
+    auto history = std::make_unique<tetris::SnapshotRing<rewind_frames>>();
+    // The simulation clock runs behind GetTime() by the time spent rewinding plus the time rewound
+    double clock_offset = 0;
 
     while (!WindowShouldClose()) {
+        TRACE_SCOPE("frame");
         BeginDrawing();
         ClearBackground(BLACK);
 
-        board.update();
-        board.draw();
+        bool was_running = board.running;
+        double now = GetTime() - clock_offset;
+        if (bot.has_value()) {
+            board.update(now, tetris::InputState{});
+            if (board.running && now - last_bot_move_time >= bot_piece_interval) {
+                last_bot_move_time = now;
+                if (std::optional<tetris::BotMove> move = bot->think(board)) {
+                    tetris::Bot::play(board, move.value());
+                }
+            }
+        } else if (can_rewind && IsKeyDown(KEY_BACKSPACE)) {
+            history->rewind(board, 1);
+            // Play resumes from the restored time with no keys held, keys still down are pressed again on the next poll
+            board.releaseKeys();
+            keyboard.down = {};
+            events.clear();
+            clock_offset = GetTime() - board.last_update_time;
+        } else if (board.running) {
+            keyboard.poll(now, events);
+            if (recorder.has_value()) {
+                now = recorder->record(tetris::toMicroseconds(now), events);
+            }
+            board.update(now, events);
+            if (can_rewind) {
+                history->save(board);
+            }
+        }
+        while (std::optional<tetris::ScoreEvent> event = board.score_events.pop()) {
+            tetris::printScoreEvent(std::cout, event.value());
+        }
+        if (was_running && !board.running) {
+            std::cout << "Game Over" << std::endl;
+        }
+        tetris::drawBoard(frame, stack, board);
+        render::RaylibBackend::submit(stack.buffer);
+        render::RaylibBackend::submit(frame);
 
         EndDrawing();
     }
 
+    if (recorder.has_value()) {
+        recorder->finish(board);
+        if (tetris::writeReplayFile(record_path.value(), recorder->replay)) {
+            std::cout << "Replay saved to " << record_path.value() << std::endl;
+        } else {
+            std::cerr << "Failed to save replay to " << record_path.value() << std::endl;
+        }
+    }
+
     CloseWindow();
+    TRACE_WRITE("tetris_trace.json");
     return 0;
 }
\ No newline at end of file
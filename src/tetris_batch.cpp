@@ -0,0 +1,668 @@
+#include "alloc_count.hpp"
+#include "board.hpp"
+#include "bot.hpp"
+#include "draw.hpp"
+#include "input.hpp"
+#include "movegen.hpp"
+#include "pcg32.hpp"
+#include "perfect_clear.hpp"
+#include "random_player.hpp"
+#include "render.hpp"
+#include "snapshot.hpp"
+#include "versus.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Headless batch runner: plays full games against the simulation core with a seeded random input policy, as fast as
+// the CPU allows, and prints a summary that can be diffed between builds.
+//
+//   tetris_batch [games] [seed] [fps] [pcg32|mt19937]
+//   tetris_batch movegen [boards] [seed]    placement enumeration over a corpus of mid-game boards
+//   tetris_batch bot [pieces] [seed] [beam_width] [depth]    one game played by the beam search bot
+//   tetris_batch locks [locks] [seed]    lock and scoring path under random drops, exits non-zero if it allocates
+//   tetris_batch render [frames] [seed]    frame encoding into the null render backend, cached stack vs full re-encode
+//   tetris_batch versus [players] [matches] [seed] [max_threads]    bot battle royale, scaling over thread counts
+//   tetris_batch pc [setups] [seed] [threads]    perfect clear search over random low stacks, answers are replayed
+//   tetris_batch rules [games] [seed]    random play on other board sizes and rotation systems, one line per rule set
+//   tetris_batch rewind [games] [seed]    rewinds random games and replays the frames, exits non-zero on a mismatch
+//   tetris_batch gravity    checks that fall speed is the same at 30, 60 and 240 FPS, exits non-zero if not
+//   tetris_batch input    replays synthetic input event streams at several frame rates, exits non-zero on a mismatch
+namespace {
+
+constexpr double max_game_seconds = 60.0 * 60.0;
+
+struct GameResult {
+    int score = 0;
+    size_t lines = 0;
+    size_t pieces = 0;
+    size_t steps = 0;
+};
+
+template <typename R = tetris::StandardRules>
+auto playGame(uint32_t seed, double frame_time, tetris::RandomizerKind randomizer) -> GameResult {
+    tetris::BasicBoard<R> board{seed, randomizer};
+    tetris::RandomPlayer player{seed ^ 0x9e3779b9U};
+    GameResult result{};
+    double now = 0;
+    while (board.running && now < max_game_seconds) {
+        board.update(now, player.next());
+        now += frame_time;
+        result.steps++;
+    }
+    result.score = board.score_state.current_score;
+    result.lines = board.total_lines_cleared;
+    result.pieces = board.pieces_locked;
+    return result;
+}
+
+// Snapshots a board every few locked pieces of random play until `num_boards` are collected
+auto collectBoards(size_t num_boards, uint32_t seed) -> std::vector<tetris::Board> {
+    constexpr size_t pieces_between_snapshots = 4;
+    std::vector<tetris::Board> corpus;
+    corpus.reserve(num_boards);
+    for (uint32_t game = 0; corpus.size() < num_boards; game++) {
+        tetris::Board board{seed + game};
+        tetris::RandomPlayer player{(seed + game) ^ 0x9e3779b9U};
+        size_t next_snapshot = pieces_between_snapshots;
+        for (double now = 0; board.running && corpus.size() < num_boards && now < max_game_seconds; now += 1 / 60.0) {
+            board.update(now, player.next());
+            if (board.running && board.pieces_locked >= next_snapshot) {
+                corpus.push_back(board);
+                next_snapshot += pieces_between_snapshots;
+            }
+        }
+    }
+    return corpus;
+}
+
+auto runMoveGen(size_t num_boards, uint32_t seed) -> int {
+    constexpr int repetitions = 20;
+    std::vector<tetris::Board> corpus = collectBoards(num_boards, seed);
+    auto generator = std::make_unique<tetris::MoveGenerator>();
+
+    size_t placements = 0;
+    size_t states = 0;
+    for (auto const& board : corpus) {
+        for (size_t t = 0; t < tetris::NUM_TETROMINOS; t++) {
+            for (auto const& p : generator->generate(board, static_cast<tetris::Tetromino>(t))) {
+                if (board.collisionCheck(static_cast<tetris::Tetromino>(t), p.position, p.orientation) ||
+                    !board.collisionCheck(static_cast<tetris::Tetromino>(t), p.position + ivec2{0, 1},
+                                          p.orientation)) {
+                    std::cerr << "invalid placement generated" << std::endl;
+                    return 1;
+                }
+                placements++;
+            }
+            states += generator->states_searched;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int rep = 0; rep < repetitions; rep++) {
+        for (auto const& board : corpus) {
+            for (size_t t = 0; t < tetris::NUM_TETROMINOS; t++) {
+                sink += generator->generate(board, static_cast<tetris::Tetromino>(t)).size();
+            }
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto calls = static_cast<double>(corpus.size() * tetris::NUM_TETROMINOS * repetitions);
+
+    std::cout << "boards: " << corpus.size() << " placements/piece: "
+              << static_cast<double>(placements) / static_cast<double>(corpus.size() * tetris::NUM_TETROMINOS)
+              << " states/piece: "
+              << static_cast<double>(states) / static_cast<double>(corpus.size() * tetris::NUM_TETROMINOS) << "\n";
+    std::cout << "us/piece: " << elapsed / calls * 1e6 << " pieces/s: " << calls / elapsed << " (" << sink << ")"
+              << std::endl;
+    return 0;
+}
+
+auto runBot(size_t max_pieces, uint32_t seed, tetris::BotConfig config) -> int {
+    tetris::Board board{seed};
+    tetris::Bot bot{config};
+    auto start = std::chrono::steady_clock::now();
+    while (board.running && board.pieces_locked < max_pieces) {
+        std::optional<tetris::BotMove> move = bot.think(board);
+        if (!move.has_value()) {
+            break;
+        }
+        tetris::Bot::play(board, move.value());
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "threads: " << bot.pool.size() << " beam: " << config.beam_width << " depth: " << config.depth
+              << "\n";
+    std::cout << "pieces: " << board.pieces_locked << " lines: " << board.total_lines_cleared
+              << " score: " << board.score_state.current_score << (board.running ? "" : " (topped out)") << "\n";
+    std::cout << "elapsed: " << elapsed << "s pieces/s: " << static_cast<double>(board.pieces_locked) / elapsed
+              << " nodes/s: " << static_cast<double>(bot.nodes_searched) / elapsed << std::endl;
+    return 0;
+}
+
+struct RenderStats {
+    double seconds = 0;
+    render::RecordingBackend backend;
+};
+
+// Plays random games at 240 FPS and encodes every frame. With `cached` off the whole stack is re-encoded each frame,
+// which is what immediate mode drawing costs.
+auto encodeFrames(size_t num_frames, uint32_t seed, bool cached) -> RenderStats {
+    constexpr double frame_time = 1 / 240.0;
+    tetris::Board board{seed};
+    tetris::RandomPlayer player{seed ^ 0x9e3779b9U};
+    tetris::StackCache stack;
+    render::CommandBuffer frame;
+    RenderStats stats{};
+    double now = 0;
+    for (size_t i = 0; i < num_frames; i++) {
+        if (!board.running) {
+            board = tetris::Board{++seed};
+        }
+        board.update(now, player.next());
+        now += frame_time;
+        if (!cached) {
+            board.dirty_rows = tetris::Board::all_rows_dirty;
+        }
+        auto start = std::chrono::steady_clock::now();
+        tetris::drawBoard(frame, stack, board);
+        stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats.backend.submit(stack.buffer);
+        stats.backend.submit(frame);
+        stats.backend.endFrame();
+    }
+    return stats;
+}
+
+auto runRender(size_t num_frames, uint32_t seed) -> int {
+    for (bool cached : {false, true}) {
+        RenderStats stats = encodeFrames(num_frames, seed, cached);
+        auto frames = static_cast<double>(stats.backend.frames);
+        std::cout << (cached ? "cached stack: " : "full encode:  ")
+                  << "ns/frame: " << stats.seconds / frames * 1e9
+                  << " draw calls/frame: " << static_cast<double>(stats.backend.draw_calls) / frames
+                  << " batches/frame: " << static_cast<double>(stats.backend.batches) / frames << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
+
+// Drops pieces at random rotations and columns, so every step is a lock: ghost drop, line clear, score event, bag
+// refill and spawn. Games that top out start over with the next seed.
+auto runLocks(size_t num_locks, uint32_t seed) -> int {
+    tetris::Board board{seed};
+    rng::Pcg32 random{seed, 7};
+    uint64_t points = 0;
+    size_t games = 1;
+    size_t const allocations_before = alloc_count::allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_locks; i++) {
+        for (uint32_t r = random.bounded(4); r > 0; r--) {
+            board.rotate(true);
+        }
+        int const dx = static_cast<int>(random.bounded(11)) - 5;
+        for (int x = 0; x != dx; x += dx > 0 ? 1 : -1) {
+            board.translate({dx > 0 ? 1 : -1, 0});
+        }
+        board.hardDrop();
+        while (std::optional<tetris::ScoreEvent> event = board.score_events.pop()) {
+            points += static_cast<uint64_t>(event->points);
+        }
+        if (!board.running) {
+            board = tetris::Board{seed + static_cast<uint32_t>(games)};
+            games++;
+        }
+    }
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t const allocations = alloc_count::allocations.load(std::memory_order_relaxed) - allocations_before;
+    std::cout << "locks: " << num_locks << " games: " << games << " points: " << points << "\n";
+    std::cout << "ns/lock: " << seconds / static_cast<double>(num_locks) * 1e9 << " allocations: " << allocations
+              << std::endl;
+    return allocations == 0 ? 0 : 1;
+}
+
+auto runVersus(size_t num_players, size_t num_matches, uint32_t seed, size_t max_threads) -> int {
+    tetris::VersusConfig config{};
+    config.players = std::max<size_t>(num_players, 2);
+    double base_rate = 0;
+    for (size_t threads = 1; threads <= max_threads;
+         threads = threads < max_threads ? std::min(threads * 2, max_threads) : max_threads + 1) {
+        std::vector<tetris::VersusMatch> matches;
+        matches.reserve(num_matches);
+        for (size_t m = 0; m < num_matches; m++) {
+            matches.emplace_back(config, seed + static_cast<uint32_t>(m));
+        }
+        tetris::WorkerPool pool{threads};
+        tetris::VersusRunner runner{pool, config.bot};
+
+        auto start = std::chrono::steady_clock::now();
+        runner.run(matches);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t boards_stepped = 0;
+        size_t rounds = 0;
+        size_t garbage = 0;
+        size_t decided = 0;
+        uint64_t checksum = 0;
+        for (auto const& match : matches) {
+            boards_stepped += match.boards_stepped;
+            rounds += match.round;
+            for (auto const& player : match.players) {
+                garbage += player.garbage_sent;
+                checksum = checksum * 31 + player.eliminated_round * 7 + player.garbage_sent;
+            }
+            decided += match.winner().has_value() ? 1 : 0;
+        }
+        double rate = static_cast<double>(boards_stepped) / elapsed;
+        base_rate = threads == 1 ? rate : base_rate;
+        std::cout << "threads: " << threads << " boards stepped/s: " << rate << " speedup: " << rate / base_rate
+                  << " elapsed: " << elapsed << "s\n";
+        std::cout << "  matches: " << num_matches << " players: " << config.players << " decided: " << decided
+                  << " avg rounds: " << static_cast<double>(rounds) / static_cast<double>(num_matches)
+                  << " garbage/board step: " << static_cast<double>(garbage) / static_cast<double>(boards_stepped)
+                  << " checksum: " << checksum << std::endl;
+    }
+    return 0;
+}
+
+template <typename R> void playRules(char const* name, size_t num_games, uint32_t seed) {
+    GameResult total{};
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_games; i++) {
+        GameResult r = playGame<R>(seed + static_cast<uint32_t>(i), 1 / 60.0, tetris::RandomizerKind::Pcg32);
+        total.lines += r.lines;
+        total.pieces += r.pieces;
+        total.steps += r.steps;
+        checksum = checksum * 31 + static_cast<uint64_t>(r.score) * 7 + r.lines * 3 + r.pieces;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << " row bytes: " << sizeof(typename R::Row) << " pieces: " << total.pieces
+              << " lines: " << total.lines << " checksum: " << checksum
+              << " steps/s: " << static_cast<double>(total.steps) / elapsed << std::endl;
+}
+
+auto runRules(size_t num_games, uint32_t seed) -> int {
+    playRules<tetris::StandardRules>("10x22 srs ", num_games, seed);
+    playRules<tetris::Rules<10, 22, tetris::SrsPlus>>("10x22 srs+", num_games, seed);
+    playRules<tetris::Rules<10, 22, tetris::Ars>>("10x22 ars ", num_games, seed);
+    playRules<tetris::Rules<20, 22, tetris::Srs>>("20x22 srs ", num_games, seed);
+    playRules<tetris::Rules<40, 26, tetris::Srs>>("40x26 srs ", num_games, seed);
+    playRules<tetris::Rules<40, 26, tetris::Ars>>("40x26 ars ", num_games, seed);
+    return 0;
+}
+
+// Plays random games saving a snapshot every frame. Every so often it rewinds a varying number of frames and simulates
+// them again with the same inputs, which has to arrive at the same state. Odd games use the mt19937 randomizer.
+auto runRewindCheck(size_t num_games, uint32_t seed) -> int {
+    constexpr size_t capacity = 240;
+    constexpr size_t rewind_interval = 97;
+    constexpr size_t max_frames = 60 * 60 * 10;
+    constexpr double frame_time = 1 / 60.0;
+    auto ring = std::make_unique<tetris::SnapshotRing<capacity>>();
+    std::vector<tetris::InputState> inputs;
+    size_t rewinds = 0;
+    size_t mismatches = 0;
+    for (size_t game = 0; game < num_games; game++) {
+        auto const kind = game % 2 == 0 ? tetris::RandomizerKind::Pcg32 : tetris::RandomizerKind::Mt19937;
+        tetris::Board board{seed + static_cast<uint32_t>(game), kind};
+        tetris::RandomPlayer player{(seed + static_cast<uint32_t>(game)) ^ 0x9e3779b9U};
+        inputs.clear();
+        ring->clear();
+        ring->save(board);
+        // The snapshot saved after `frame` updates is the state the next update starts from
+        for (size_t frame = 0; board.running && frame < max_frames;) {
+            inputs.push_back(player.next());
+            board.update(static_cast<double>(frame) * frame_time, inputs.back());
+            frame++;
+            ring->save(board);
+            size_t const age = 1 + (frame / rewind_interval) % (capacity - 1);
+            if (frame % rewind_interval != 0 || age >= ring->size()) {
+                continue;
+            }
+            tetris::BoardSnapshot expected{};
+            expected.save(board);
+            std::optional<std::mt19937> expected_generator;
+            if (board.randomizer.mt19937) {
+                expected_generator = board.randomizer.mt19937->g;
+            }
+            ring->rewind(board, age);
+            for (size_t f = frame - age; f < frame; f++) {
+                board.update(static_cast<double>(f) * frame_time, inputs[f]);
+                ring->save(board);
+            }
+            tetris::BoardSnapshot actual{};
+            actual.save(board);
+            bool const same_generator =
+                !expected_generator.has_value() || expected_generator == board.randomizer.mt19937->g;
+            mismatches += actual == expected && same_generator ? 0 : 1;
+            rewinds++;
+        }
+    }
+    std::cout << "games: " << num_games << " rewinds: " << rewinds << " mismatches: " << mismatches
+              << " snapshot bytes: " << sizeof(tetris::BoardSnapshot) << " board bytes: " << sizeof(tetris::Board)
+              << "\n";
+    std::cout << (mismatches == 0 ? "rewound games replay identically" : "rewound games diverge") << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// One to four random placements inside the bottom four rows that leave no holes and clear no line, the kind of stack a
+// perfect clear is built from
+auto perfectClearSetup(uint32_t seed, tetris::MoveGenerator& generator) -> tetris::Board {
+    tetris::Board board{seed};
+    rng::Pcg32 g{seed, 7};
+    uint32_t const pieces = 1 + g.bounded(4);
+    std::vector<tetris::Placement> low;
+    for (uint32_t i = 0; i < pieces; i++) {
+        low.clear();
+        for (auto const& p : generator.generate(board, board.active_piece.type)) {
+            tetris::Rows rows = board.rows;
+            tetris::placePiece(rows, board.active_piece.type, p.position, p.orientation);
+            if (p.position.y + tetris::piece_masks[board.active_piece.type][p.orientation].min_y >=
+                    tetris::num_rows - 4 &&
+                tetris::surfaceFeatures(rows).holes == 0 && tetris::clearFullRows(rows) == 0) {
+                low.push_back(p);
+            }
+        }
+        if (low.empty()) {
+            break;
+        }
+        tetris::Bot::play(board, tetris::BotMove{.use_hold = false,
+                                                 .placement = low[g.bounded(static_cast<uint32_t>(low.size()))]});
+    }
+    return board;
+}
+
+// Plays the finder's answer and checks that the last piece empties the board
+auto perfectClearHolds(tetris::Board board, tetris::PerfectClear const& pc) -> bool {
+    std::optional<tetris::ScoreEvent> last;
+    for (auto const& move : pc.moves) {
+        last.reset();
+        tetris::Bot::play(board, move);
+        while (std::optional<tetris::ScoreEvent> event = board.score_events.pop()) {
+            last = event;
+        }
+    }
+    return last.has_value() && last->perfect_clear && tetris::fieldEmpty(board.rows);
+}
+
+auto runPerfectClear(size_t num_setups, uint32_t seed, size_t threads) -> int {
+    auto generator = std::make_unique<tetris::MoveGenerator>();
+    tetris::PerfectClearFinder finder{tetris::PerfectClearConfig{.threads = threads}};
+    std::vector<double> times;
+    std::array<size_t, 5> solved_by_lines{};
+    uint64_t checksum = 0;
+    bool ok = true;
+    for (size_t i = 0; i < num_setups; i++) {
+        tetris::Board board = perfectClearSetup(seed + static_cast<uint32_t>(i), *generator);
+        auto start = std::chrono::steady_clock::now();
+        std::optional<tetris::PerfectClear> pc = finder.find(board);
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3);
+        if (!pc.has_value()) {
+            continue;
+        }
+        solved_by_lines[static_cast<size_t>(pc->lines)]++;
+        for (auto const& move : pc->moves) {
+            checksum = checksum * 31 + static_cast<uint64_t>(move.use_hold) * 7 +
+                       static_cast<uint64_t>(move.placement.position.x * 100 + move.placement.position.y) * 5 +
+                       move.placement.orientation;
+        }
+        if (!perfectClearHolds(board, pc.value())) {
+            std::cerr << "setup " << seed + i << ": move sequence does not perfect clear" << std::endl;
+            ok = false;
+        }
+    }
+    std::vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+    size_t solved = 0;
+    for (size_t n : solved_by_lines) {
+        solved += n;
+    }
+    std::cout << "threads: " << finder.pool.size() << " setups: " << num_setups << " solved: " << solved
+              << " (1/2/3/4 lines: " << solved_by_lines[1] << "/" << solved_by_lines[2] << "/" << solved_by_lines[3]
+              << "/" << solved_by_lines[4] << ") checksum: " << checksum << "\n";
+    std::cout << "ms/setup mean: " << total / static_cast<double>(times.size())
+              << " p50: " << sorted[sorted.size() / 2] << " p99: " << sorted[sorted.size() * 99 / 100]
+              << " max: " << sorted.back() << " nodes: " << finder.nodes_searched << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Drops the first piece on an empty board and samples how many rows it has fallen every 1/30 s, a time every tested
+// frame rate steps on. Sampling stops once the piece rests on the floor.
+auto sampleFall(int level, bool soft_drop, int fps) -> std::vector<int> {
+    constexpr int sample_rate = 30;
+    tetris::Board board{1};
+    board.level = level;
+    board.tick_rate = soft_drop ? tetris::level_down_tick_rates[level] : tetris::level_tick_rates[level];
+    tetris::Piece const& piece = board.active_piece;
+    int const start_y = piece.position.y;
+    int const floor_y = start_y + board.dropDistance(piece.type, piece.position, piece.orientation);
+    std::vector<int> samples;
+    for (int step = 1; step <= 2 * fps && board.pieces_locked == 0; step++) {
+        board.update(static_cast<double>(step) / fps, tetris::InputState{.soft_drop_held = soft_drop});
+        if (step % (fps / sample_rate) == 0) {
+            samples.push_back(piece.position.y - start_y);
+            if (piece.position.y == floor_y) {
+                break;
+            }
+        }
+    }
+    return samples;
+}
+
+auto runGravity() -> int {
+    constexpr std::array<int, 3> frame_rates = {30, 60, 240};
+    bool consistent = true;
+    for (int level = 0; level < tetris::num_levels; level++) {
+        for (bool soft_drop : {false, true}) {
+            std::array<std::vector<int>, frame_rates.size()> samples;
+            for (size_t f = 0; f < frame_rates.size(); f++) {
+                samples[f] = sampleFall(level, soft_drop, frame_rates[f]);
+            }
+            // Rounding of the accumulated frame times may put a row boundary on either side of a sample
+            int max_difference = 0;
+            for (size_t f = 1; f < frame_rates.size(); f++) {
+                consistent = consistent && samples[f].size() == samples[0].size();
+                for (size_t i = 0; i < std::min(samples[f].size(), samples[0].size()); i++) {
+                    max_difference = std::max(max_difference, std::abs(samples[f][i] - samples[0][i]));
+                }
+            }
+            consistent = consistent && max_difference <= 1;
+            double expected = 1 / (soft_drop ? tetris::level_down_tick_rates[level] : tetris::level_tick_rates[level]);
+            std::cout << "level " << level + 1 << (soft_drop ? " soft drop" : "          ") << " rows/s: " << expected
+                      << " rows after 1/30 s:";
+            for (auto const& s : samples) {
+                std::cout << " " << s.front();
+            }
+            std::cout << " samples to floor:";
+            for (auto const& s : samples) {
+                std::cout << " " << s.size();
+            }
+            std::cout << " max difference: " << max_difference << "\n";
+        }
+    }
+    std::cout << (consistent ? "gravity is frame rate independent" : "gravity differs between frame rates")
+              << std::endl;
+    return consistent ? 0 : 1;
+}
+
+// Feeds `stream` to a fresh board stepped at `fps` until `end` and returns where the active piece ended up
+auto replayEvents(std::span<tetris::InputEvent const> stream, int fps, double end) -> ivec2 {
+    tetris::Board board{1};
+    tetris::InputEventQueue events;
+    size_t next = 0;
+    for (int step = 1; static_cast<double>(step - 1) / fps < end; step++) {
+        double const now = std::min(static_cast<double>(step) / fps, end);
+        // Events reach the queue as soon as they happen, like a capture thread would deliver them. One that doesn't fit
+        // waits for the next step.
+        while (next < stream.size() && stream[next].time <= now && events.push(stream[next])) {
+            next++;
+        }
+        board.update(now, events);
+    }
+    return board.active_piece.position;
+}
+
+auto runInputCheck() -> int {
+    using tetris::InputEvent;
+    using tetris::Key;
+    struct Case {
+        char const* name;
+        std::vector<InputEvent> stream;
+        double end;
+        // Expected horizontal travel from the spawn column
+        int shift;
+    };
+    // Auto-repeat shifts come slide_delay_period + slide_rate after the press and every slide_rate after that
+    std::vector<Case> const cases = {
+        {"tap between frames",
+         {InputEvent{0.010, Key::Right, true}, InputEvent{0.012, Key::Right, false}},
+         0.1,
+         1},
+        {"das and arr",
+         {InputEvent{0.013, Key::Right, true}, InputEvent{0.2, Key::Right, false}},
+         0.25,
+         3},
+        {"several repeats per frame",
+         {InputEvent{0.0, Key::Left, true}, InputEvent{0.17, Key::Left, false}},
+         0.25,
+         -3},
+        {"opposite direction takes over",
+         {InputEvent{0.0, Key::Left, true}, InputEvent{0.05, Key::Right, true}, InputEvent{0.06, Key::Right, false},
+          InputEvent{0.07, Key::Left, false}},
+         0.1,
+         -2},
+    };
+    constexpr std::array<int, 4> frame_rates = {10, 30, 60, 240};
+    int const spawn_x = tetris::Board{1}.active_piece.position.x;
+    bool ok = true;
+    for (auto const& c : cases) {
+        std::cout << c.name << ":";
+        for (int fps : frame_rates) {
+            ivec2 position = replayEvents(c.stream, fps, c.end);
+            bool const match = position.x - spawn_x == c.shift;
+            ok = ok && match;
+            std::cout << " " << fps << "fps x" << (position.x - spawn_x >= 0 ? "+" : "") << position.x - spawn_x
+                      << (match ? "" : " (expected " + std::to_string(c.shift) + ")");
+        }
+        std::cout << "\n";
+    }
+    std::cout << (ok ? "input timing is frame rate independent" : "input timing differs") << std::endl;
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc > 1 && std::string_view{argv[1]} == "movegen") {
+        size_t num_boards = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        return runMoveGen(num_boards, seed);
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "bot") {
+        size_t max_pieces = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        tetris::BotConfig config{};
+        config.beam_width = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : config.beam_width;
+        config.depth = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : config.depth;
+        return runBot(max_pieces, seed, config);
+    }
+
+    if (argc > 1 && std::string_view{argv[1]} == "locks") {
+        size_t num_locks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        return runLocks(std::max<size_t>(num_locks, 1), seed);
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "render") {
+        size_t num_frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        return runRender(num_frames, seed);
+    }
+
+    if (argc > 1 && std::string_view{argv[1]} == "pc") {
+        size_t num_setups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        size_t threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+        return runPerfectClear(std::max<size_t>(num_setups, 1), seed, threads);
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "rules") {
+        size_t num_games = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        return runRules(num_games, seed);
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "rewind") {
+        size_t num_games = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+        uint32_t seed = argc > 3 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+        return runRewindCheck(num_games, seed);
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "input") {
+        return runInputCheck();
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "gravity") {
+        return runGravity();
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "versus") {
+        size_t num_players = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+        size_t num_matches = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 16;
+        uint32_t seed = argc > 4 ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 1;
+        size_t max_threads = argc > 5 ? std::strtoul(argv[5], nullptr, 10)
+                                      : std::max(1U, std::thread::hardware_concurrency());
+        return runVersus(num_players, num_matches, seed, std::max<size_t>(max_threads, 1));
+    }
+
+    size_t num_games = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    uint32_t seed = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 1;
+    double fps = argc > 3 ? std::strtod(argv[3], nullptr) : 60;
+    auto randomizer = argc > 4 && std::string_view{argv[4]} == "mt19937" ? tetris::RandomizerKind::Mt19937
+                                                                           : tetris::RandomizerKind::Pcg32;
+    size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    std::vector<GameResult> results(num_games);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < num_threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < num_games; i += num_threads) {
+                results[i] = playGame(seed + static_cast<uint32_t>(i), 1 / fps, randomizer);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    GameResult total{};
+    uint64_t checksum = 0;
+    for (auto const& r : results) {
+        total.score += r.score;
+        total.lines += r.lines;
+        total.pieces += r.pieces;
+        total.steps += r.steps;
+        checksum = checksum * 31 + static_cast<uint64_t>(r.score) * 7 + r.lines * 3 + r.pieces;
+    }
+
+    std::cout << "games: " << num_games << " threads: " << num_threads << " fps: " << fps << " randomizer: "
+              << (randomizer == tetris::RandomizerKind::Mt19937 ? "mt19937" : "pcg32") << "\n";
+    std::cout << "pieces: " << total.pieces << " lines: " << total.lines << " score: " << total.score
+              << " checksum: " << checksum << "\n";
+    std::cout << "elapsed: " << elapsed << "s games/s: " << static_cast<double>(num_games) / elapsed
+              << " steps/s: " << static_cast<double>(total.steps) / elapsed << std::endl;
+    return 0;
+}
@@ -0,0 +1,370 @@
+#include "input.hpp"
+#include "net.hpp"
+#include "random_player.hpp"
+#include "replay.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <vector>
+
+// Load generator for tetris_server. Opens --clients connections, each playing back-to-back matches with a random
+// player that sends its inputs --input-hz times a second, and reports:
+//
+//   input latency      from sending an input to the Delta that acknowledges it, p50/p99/p99.9/max
+//   matches            completed during the run, per second and per second of server CPU time
+//
+// Options: --host <ipv4> --port <n> --clients <n> --seconds <n> --input-hz <n>
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Send times of the inputs in flight, indexed by echo
+constexpr uint32_t echo_window = 1024;
+// A random player frame produces at most one event per key
+constexpr uint32_t max_in_flight = echo_window - static_cast<uint32_t>(tetris::Key::NumKeys);
+
+struct Options {
+    std::string host = "127.0.0.1";
+    uint16_t port = 7777;
+    size_t clients = 1000;
+    double seconds = 10;
+    int input_hz = 60;
+};
+
+struct ServerStats {
+    uint64_t cpu_us;
+    uint64_t ticks;
+    uint64_t matches;
+    uint32_t sessions;
+    uint32_t tick_p50_us;
+    uint32_t tick_p99_us;
+    uint32_t tick_max_us;
+};
+
+struct Client {
+    int fd;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    size_t out_sent = 0;
+    tetris::RandomPlayer player;
+    tetris::InputState previous{};
+    uint32_t seed;
+    bool in_match = false;
+    // Match clock of the newest Delta, which inputs are stamped with
+    uint32_t server_time_us = 0;
+    uint32_t next_echo = 0;
+    uint32_t acked = 0;
+    std::array<Clock::time_point, echo_window> sent_at{};
+
+    Client(int socket, uint32_t client_seed) : fd(socket), player(client_seed ^ 0x9e3779b9U), seed(client_seed) {}
+};
+
+struct LoadGenerator {
+    Options options;
+    int epoll_fd = -1;
+    int timer_fd = -1;
+    std::vector<std::unique_ptr<Client>> clients;
+    std::vector<uint32_t> latencies_us;
+    uint64_t inputs_sent = 0;
+    uint64_t matches = 0;
+    size_t disconnects = 0;
+    std::optional<ServerStats> stats;
+
+    explicit LoadGenerator(Options const& load_options) : options(load_options) {}
+    LoadGenerator(LoadGenerator const&) = delete;
+    auto operator=(LoadGenerator const&) -> LoadGenerator& = delete;
+
+    auto connectAll() -> bool {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options.port);
+        if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+            std::cerr << "not an IPv4 address: " << options.host << std::endl;
+            return false;
+        }
+        epoll_fd = epoll_create1(0);
+        for (size_t i = 0; i < options.clients; i++) {
+            int const fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                std::cerr << "connection " << i << " failed: " << std::strerror(errno) << std::endl;
+                if (fd >= 0) {
+                    close(fd);
+                }
+                return false;
+            }
+            tetris::setNonBlocking(fd);
+            tetris::setNoDelay(fd);
+            auto& client = clients.emplace_back(std::make_unique<Client>(fd, static_cast<uint32_t>(i) * 7919U));
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = client.get();
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        }
+        return true;
+    }
+
+    ~LoadGenerator() {
+        for (auto& client : clients) {
+            if (client->fd >= 0) {
+                close(client->fd);
+            }
+        }
+        for (int fd : {timer_fd, epoll_fd}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    auto startTimer() -> bool {
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (timer_fd < 0) {
+            return false;
+        }
+        long const period_ns = 1'000'000'000L / options.input_hz;
+        itimerspec period{};
+        period.it_interval.tv_sec = period_ns / 1'000'000'000L;
+        period.it_interval.tv_nsec = period_ns % 1'000'000'000L;
+        period.it_value = period.it_interval;
+        if (timerfd_settime(timer_fd, 0, &period, nullptr) != 0) {
+            return false;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = &timer_fd;
+        return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) == 0;
+    }
+
+    static void sendHello(Client& c) {
+        size_t const frame = tetris::beginFrame(c.out, tetris::MessageType::Hello);
+        tetris::putU32(c.out, c.seed++);
+        tetris::putU8(c.out, static_cast<uint8_t>(tetris::RandomizerKind::Pcg32));
+        tetris::endFrame(c.out, frame);
+    }
+
+    void sendInputs(Client& c, Clock::time_point now) {
+        if (!c.in_match || c.next_echo - c.acked >= max_in_flight) {
+            return;
+        }
+        tetris::InputState const input = c.player.next();
+        tetris::InputEventQueue events;
+        tetris::pushInputChanges(c.previous, input, tetris::toSeconds(c.server_time_us), events);
+        c.previous = input;
+        while (std::optional<tetris::InputEvent> event = events.pop()) {
+            c.next_echo++;
+            c.sent_at[c.next_echo % echo_window] = now;
+            size_t const frame = tetris::beginFrame(c.out, tetris::MessageType::Input);
+            tetris::putU32(c.out, c.server_time_us);
+            tetris::putU8(c.out, tetris::packEvent(*event));
+            tetris::putU32(c.out, c.next_echo);
+            tetris::endFrame(c.out, frame);
+            inputs_sent++;
+        }
+    }
+
+    void onFrame(Client& c, tetris::MessageType type, tetris::FrameReader& reader, Clock::time_point now) {
+        switch (type) {
+        case tetris::MessageType::Welcome:
+            c.in_match = true;
+            c.server_time_us = 0;
+            c.previous = {};
+            break;
+        case tetris::MessageType::Delta: {
+            c.server_time_us = reader.u32();
+            uint32_t const echo = reader.u32();
+            // Echoes from before the last GameOver are stale
+            if (echo - c.acked > c.next_echo - c.acked) {
+                break;
+            }
+            for (; c.acked != echo; c.acked++) {
+                auto const latency = now - c.sent_at[(c.acked + 1) % echo_window];
+                latencies_us.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+            }
+            break;
+        }
+        case tetris::MessageType::GameOver:
+            matches++;
+            // The server drops what was still queued, those inputs are never acknowledged
+            c.acked = c.next_echo;
+            c.in_match = false;
+            sendHello(c);
+            break;
+        case tetris::MessageType::Stats:
+            stats = ServerStats{.cpu_us = reader.u64(),
+                                .ticks = reader.u64(),
+                                .matches = reader.u64(),
+                                .sessions = reader.u32(),
+                                .tick_p50_us = reader.u32(),
+                                .tick_p99_us = reader.u32(),
+                                .tick_max_us = reader.u32()};
+            break;
+        default:
+            break;
+        }
+    }
+
+    void flush(Client& c) {
+        if (c.fd >= 0 && !tetris::flushSocket(c.fd, c.out, c.out_sent)) {
+            drop(c);
+        }
+    }
+
+    void drop(Client& c) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c.fd, nullptr);
+        close(c.fd);
+        c.fd = -1;
+        c.in_match = false;
+        disconnects++;
+    }
+
+    void readFrom(Client& c, Clock::time_point now) {
+        std::array<uint8_t, 16384> buffer{};
+        while (true) {
+            ssize_t const n = recv(c.fd, buffer.data(), buffer.size(), 0);
+            if (n > 0) {
+                c.in.insert(c.in.end(), buffer.begin(), buffer.begin() + n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else {
+                drop(c);
+                return;
+            }
+        }
+        size_t const consumed = tetris::forEachFrame(
+            c.in, [&](tetris::MessageType type, tetris::FrameReader reader) { onFrame(c, type, reader, now); });
+        c.in.erase(c.in.begin(), c.in.begin() + static_cast<std::ptrdiff_t>(consumed));
+        flush(c);
+    }
+
+    // Handles one batch of events, sending inputs if the input timer fired
+    void pump(int timeout_ms) {
+        std::array<epoll_event, 256> ready{};
+        int const n = epoll_wait(epoll_fd, ready.data(), static_cast<int>(ready.size()), timeout_ms);
+        Clock::time_point const now = Clock::now();
+        for (int i = 0; i < n; i++) {
+            if (ready[i].data.ptr == &timer_fd) {
+                uint64_t expirations = 0;
+                if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                    for (auto& client : clients) {
+                        if (client->fd >= 0) {
+                            sendInputs(*client, now);
+                            flush(*client);
+                        }
+                    }
+                }
+                continue;
+            }
+            Client& c = *static_cast<Client*>(ready[i].data.ptr);
+            if (c.fd >= 0) {
+                readFrom(c, now);
+            }
+        }
+    }
+
+    auto requestStats(Clock::duration timeout) -> std::optional<ServerStats> {
+        Client& c = *clients.front();
+        if (c.fd < 0) {
+            return {};
+        }
+        stats.reset();
+        size_t const frame = tetris::beginFrame(c.out, tetris::MessageType::StatsRequest);
+        tetris::endFrame(c.out, frame);
+        flush(c);
+        Clock::time_point const deadline = Clock::now() + timeout;
+        while (!stats.has_value() && Clock::now() < deadline && c.fd >= 0) {
+            pump(10);
+        }
+        return stats;
+    }
+};
+
+auto percentile(std::vector<uint32_t>& values, double p) -> uint32_t {
+    if (values.empty()) {
+        return 0;
+    }
+    auto const rank = static_cast<size_t>(p / 100 * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+    return values[rank];
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view arg{argv[i]};
+        char const* value = argv[i + 1];
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--clients") {
+            options.clients = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--seconds") {
+            options.seconds = std::strtod(value, nullptr);
+        } else if (arg == "--input-hz") {
+            options.input_hz = std::max(1, std::atoi(value));
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    tetris::raiseFileLimit();
+    LoadGenerator load{options};
+    if (!load.connectAll()) {
+        return EXIT_FAILURE;
+    }
+    std::optional<ServerStats> const before = load.requestStats(std::chrono::seconds{2});
+    for (auto& client : load.clients) {
+        LoadGenerator::sendHello(*client);
+        load.flush(*client);
+    }
+    if (!load.startTimer()) {
+        std::cerr << "cannot start the input timer: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Clock::time_point const start = Clock::now();
+    auto const run_time = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{options.seconds});
+    while (Clock::now() - start < run_time) {
+        load.pump(10);
+    }
+    double const elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t const matches = load.matches;
+    std::optional<ServerStats> const after = load.requestStats(std::chrono::seconds{2});
+
+    std::vector<uint32_t>& latencies = load.latencies_us;
+    std::cout << "clients: " << options.clients << " seconds: " << elapsed << " inputs sent: " << load.inputs_sent
+              << " acknowledged: " << latencies.size() << " disconnects: " << load.disconnects << "\n";
+    std::cout << "input latency us p50/p99/p99.9/max: " << percentile(latencies, 50) << "/"
+              << percentile(latencies, 99) << "/" << percentile(latencies, 99.9) << "/" << percentile(latencies, 100)
+              << "\n";
+    std::cout << "matches: " << matches << " (" << static_cast<double>(matches) / elapsed << "/s)\n";
+    if (before.has_value() && after.has_value()) {
+        double const cpu_seconds = static_cast<double>(after->cpu_us - before->cpu_us) * 1e-6;
+        std::cout << "server cpu: " << cpu_seconds << "s, matches per core-second: "
+                  << static_cast<double>(after->matches - before->matches) / cpu_seconds
+                  << ", tick p50/p99/max us: " << after->tick_p50_us << "/" << after->tick_p99_us << "/"
+                  << after->tick_max_us << "\n";
+    } else {
+        std::cout << "server stats unavailable\n";
+    }
+    std::cout << std::flush;
+    return load.disconnects == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
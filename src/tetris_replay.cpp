@@ -0,0 +1,101 @@
+#include "board.hpp"
+#include "input.hpp"
+#include "random_player.hpp"
+#include "replay.hpp"
+#include "worker_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Replay tooling:
+//
+//   tetris_replay verify <files...>                 re-simulate every replay in parallel and check score and lines
+//   tetris_replay generate <dir> <count> [seed]     write replays of random headless games, for load testing
+namespace {
+
+constexpr uint64_t max_game_us = 60ULL * 60 * 1000 * 1000;
+
+auto generate(std::string const& dir, size_t count, uint32_t seed) -> int {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t game_seed = seed + static_cast<uint32_t>(i);
+        tetris::Board board{game_seed};
+        tetris::RandomPlayer player{game_seed ^ 0x9e3779b9U};
+        tetris::ReplayRecorder recorder{game_seed};
+        // Frame pacing with a little jitter, like a real display loop
+        std::mt19937 jitter{game_seed};
+        std::uniform_int_distribution<uint64_t> frame_us{16000, 17400};
+        tetris::InputEventQueue events;
+        tetris::InputState previous{};
+        for (uint64_t now_us = 0; board.running && now_us < max_game_us; now_us += frame_us(jitter)) {
+            tetris::InputState input = player.next();
+            tetris::pushInputChanges(previous, input, tetris::toSeconds(now_us), events);
+            previous = input;
+            board.update(recorder.record(now_us, events), events);
+        }
+        recorder.finish(board);
+        std::string path = dir + "/replay_" + std::to_string(i) + ".ttrp";
+        if (!tetris::writeReplayFile(path, recorder.replay)) {
+            std::cerr << "failed to write " << path << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "wrote " << count << " replays to " << dir << std::endl;
+    return 0;
+}
+
+auto verify(std::vector<std::string> const& paths) -> int {
+    tetris::WorkerPool pool{};
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> valid{0};
+    std::atomic<uint64_t> frames{0};
+    std::mutex report_mutex;
+    std::vector<std::string> failures;
+
+    auto start = std::chrono::steady_clock::now();
+    auto job = [&](size_t /*worker*/) {
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            std::optional<tetris::Replay> replay = tetris::readReplayFile(paths[i]);
+            if (replay.has_value() && tetris::verifyReplay(replay.value())) {
+                valid++;
+                frames += replay->num_frames;
+            } else {
+                std::lock_guard lock{report_mutex};
+                failures.push_back(paths[i] + (replay.has_value() ? ": score mismatch" : ": unreadable"));
+            }
+        }
+    };
+    pool.run(job);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto const& failure : failures) {
+        std::cout << "FAIL " << failure << "\n";
+    }
+    std::cout << "replays: " << paths.size() << " valid: " << valid << " invalid: " << failures.size()
+              << " threads: " << pool.size() << "\n";
+    std::cout << "elapsed: " << elapsed << "s replays/s: " << static_cast<double>(paths.size()) / elapsed
+              << " frames/s: " << static_cast<double>(frames) / elapsed << std::endl;
+    return failures.empty() ? 0 : 1;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    std::string_view mode = argc > 1 ? argv[1] : "";
+    if (mode == "verify" && argc > 2) {
+        return verify(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (mode == "generate" && argc > 3) {
+        uint32_t seed = argc > 4 ? static_cast<uint32_t>(std::strtoul(argv[4], nullptr, 10)) : 1;
+        return generate(argv[2], std::strtoul(argv[3], nullptr, 10), seed);
+    }
+    std::cerr << "usage: tetris_replay verify <files...> | generate <dir> <count> [seed]" << std::endl;
+    return 1;
+}
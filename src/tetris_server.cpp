@@ -0,0 +1,67 @@
+#include "match_server.hpp"
+#include "net.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <unistd.h>
+
+// Authoritative match server on localhost, see match_server.hpp and net.hpp. Options:
+//
+//   --port <n>       TCP port, 7777 by default
+//   --tick-hz <n>    board steps per second, 60 by default
+//   --speed <x>      game seconds per real second, to get through matches faster under load
+//   --threads <n>    workers stepping the boards, one per core by default
+//   --seconds <n>    stop after this long instead of at SIGINT
+//
+// Prints a summary of tick times and matches per CPU second when it stops. tetris_loadgen drives it.
+namespace {
+
+std::atomic<bool> stop{false};
+
+void requestStop(int /*signal*/) { stop.store(true); }
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+    tetris::ServerConfig config;
+    unsigned seconds = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view arg{argv[i]};
+        char const* value = argv[i + 1];
+        if (arg == "--port") {
+            config.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--tick-hz") {
+            config.tick_hz = std::max(1, std::atoi(value));
+        } else if (arg == "--speed") {
+            config.speed = std::strtod(value, nullptr);
+        } else if (arg == "--threads") {
+            config.threads = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--seconds") {
+            seconds = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    tetris::raiseFileLimit();
+    tetris::MatchServer server{config};
+    if (!server.open()) {
+        std::cerr << "cannot listen on port " << config.port << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::signal(SIGALRM, requestStop);
+    if (seconds > 0) {
+        alarm(seconds);
+    }
+    std::cout << "listening on 127.0.0.1:" << config.port << " at " << config.tick_hz << " ticks/s with "
+              << config.threads << " workers" << std::endl;
+    server.run(stop);
+    server.writeSummary(std::cout);
+    return EXIT_SUCCESS;
+}